@@ -1,186 +1,2092 @@
 #include <iostream>
-#include <sstream>
+#include <charconv>
+#include <limits>
+#include <string_view>
+#include <string>
 #include <cmath>
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+#include <optional>
+#include <span>
+#include <thread>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 
-#define WIDTH 10
-#define HEIGHT 10
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#if defined(__AVX2__) || defined(__SSE4_1__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Границы по умолчанию для Point2d
+constexpr int WIDTH = 10;
+constexpr int HEIGHT = 10;
+
+// Запись в буфер [first, last) без выделения памяти. Возвращают указатель
+// за последним записанным символом или nullptr, если место закончилось.
+inline char* write_text(char* first, char* last, std::string_view text) noexcept {
+    if (!first || (size_t)(last - first) < text.size()) {
+        return nullptr;
+    }
+    return std::copy(text.begin(), text.end(), first);
+}
+
+// Вещественные числа пишутся как в std::ostream по умолчанию (%g, 6 знаков)
+template <typename T>
+char* write_number(char* first, char* last, T value) noexcept {
+    if (!first) {
+        return nullptr;
+    }
+    std::to_chars_result r;
+    if constexpr (std::is_integral_v<T>) {
+        r = std::to_chars(first, last, value);
+    } else {
+        r = std::to_chars(first, last, value, std::chars_format::general, 6);
+    }
+    return r.ec == std::errc() ? r.ptr : nullptr;
+}
+
+// Наибольшая длина записи числа типа T
+template <typename T>
+constexpr size_t max_number_len = std::is_integral_v<T> ? std::numeric_limits<T>::digits10 + 2 : 16;
+
+// "{<name>: x = <x>, y = <y>}"
+template <typename T>
+char* write_xy(char* first, char* last, std::string_view name, T x, T y) noexcept {
+    first = write_text(first, last, "{");
+    first = write_text(first, last, name);
+    first = write_text(first, last, ": x = ");
+    first = write_number(first, last, x);
+    first = write_text(first, last, ", y = ");
+    first = write_number(first, last, y);
+    return write_text(first, last, "}");
+}
+
+// Пишет элементы через separator одной строкой в буфер вызывающего кода.
+// Буфера размером items.size() * (Item::max_str_len + 1) достаточно всегда.
+template <typename Item>
+char* format_all(std::span<const Item> items, char* first, char* last, char separator = '\n') noexcept {
+    for (const Item& item: items) {
+        first = item.format_to(first, last);
+        first = write_text(first, last, std::string_view(&separator, 1));
+    }
+    return first;
+}
+
+// Точка с координатами типа T (int, long long, float, double) в области
+// [0, W] x [0, H]. Границы - параметры шаблона, поэтому проверка сводится
+// к сравнению с константами, а конструктор без проверки - к двум записям.
+template <typename T = int, T W = T(WIDTH), T H = T(HEIGHT)>
 class Point2d {
 private:
 
-    int x;
-    int y;
+    T x;
+    T y;
 
 public:
-    void set_x(int n) {
-        if (0 <= n && n <= WIDTH) {
+    static constexpr T width = W;
+    static constexpr T height = H;
+
+    static constexpr bool in_bounds(T x, T y) noexcept {
+        return 0 <= x && x <= W && 0 <= y && y <= H;
+    }
+
+    // Проверенное создание: пусто, если точка вне области
+    static constexpr std::optional<Point2d> make(T x, T y) noexcept {
+        if (!in_bounds(x, y)) {
+            return std::nullopt;
+        }
+        return Point2d(x, y);
+    }
+
+    constexpr bool set_x(T n) noexcept {
+        if (0 <= n && n <= W) {
             x = n;
-        } else {
-            std::cerr << "Point2d: x must be lower or eq " << WIDTH << " and greater or eq 0\n";
+            return true;
         }
+        return false;
     }
 
-    void set_y(int n) {
-        if (0 <= n && n <= HEIGHT) {
+    constexpr bool set_y(T n) noexcept {
+        if (0 <= n && n <= H) {
             y = n;
-        } else {
-            std::cerr << "Point2d: y must be lower or eq " << HEIGHT << " and greater or eq 0\n";
+            return true;
         }
+        return false;
     }
 
-    int get_x() { return x; }
-    int get_y() { return y; }
+    constexpr T get_x() const noexcept { return x; }
+    constexpr T get_y() const noexcept { return y; }
 
 
-    Point2d(int x, int y) {
-        set_x(x);
-        set_y(y);
-    }
+    constexpr Point2d() noexcept: x(0), y(0) {}
 
-    bool eq(const Point2d& other) {
+    // Без проверки границ - для заранее проверенных данных, см. make()
+    constexpr Point2d(T x, T y) noexcept: x(x), y(y) {}
+
+    constexpr bool eq(const Point2d& other) const noexcept {
         return x == other.x && y == other.y;
     }
 
-    std::string str() {
-        std::stringstream s;
-        s << "{Point2d: x = " << x << ", y = " << y << "}"; 
-        return s.str();
+    // Наибольшая длина результата str()/format_to()
+    static constexpr size_t max_str_len = 21 + 2 * max_number_len<T>;
+
+    char* format_to(char* first, char* last) const noexcept {
+        return write_xy(first, last, "Point2d", x, y);
+    }
+
+    std::string str() const {
+        char buf[max_str_len];
+        return std::string(buf, format_to(buf, buf + max_str_len));
     }
 };
 
+// Тип для накопления произведений координат без переполнения
+template <typename T>
+using wide_t = std::conditional_t<std::is_integral_v<T>, long long, double>;
+
+static_assert(!Point2d<>::make(WIDTH + 1, 0).has_value());
+static_assert(Point2d<int, 100, 50>::make(100, 50)->get_y() == 50);
+
+template <typename T>
 class Vector2d;
 
+// Непрерывный итератор по координатам: x0, y0, x1, y1, ... Vector2d хранит
+// x и y подряд без заполнения, поэтому массив векторов обходится как массив T
+// и std-алгоритмы (в том числе параллельные) работают с ним как с указателем.
+template <typename T = int>
 class Iterator {
 private:
-    int i = 0;
-    Vector2d& vec;
+    T* p = nullptr;
 public:
-    Iterator(Vector2d& vec): vec(vec) {}
-    Iterator(Vector2d& vec, int i): vec(vec), i(i) {}
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept = std::contiguous_iterator_tag;
+    using value_type = std::remove_cv_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
 
-    bool operator==(const Iterator& other) {
-        return i == other.i;
-    }
+    Iterator() = default;
+    explicit Iterator(T* p): p(p) {}
+    Iterator(Vector2d<value_type>& vec): p(&vec.getitem(0)) {}
+    Iterator(Vector2d<value_type>& vec, int i): p(&vec.getitem(0) + i) {}
 
-    bool operator!=(const Iterator& other) {
-        return i != other.i;
-    }
+    bool operator==(const Iterator& other) const = default;
+    auto operator<=>(const Iterator& other) const = default;
+
+    T& operator*() const { return *p; }
+    T* operator->() const { return p; }
+    T& operator[](difference_type n) const { return p[n]; }
 
     Iterator& operator++() {
-        ++i;
+        ++p;
         return (*this);
     }
 
-    int& operator*();
+    Iterator operator++(int) { return Iterator(p++); }
+    Iterator& operator--() { --p; return *this; }
+    Iterator operator--(int) { return Iterator(p--); }
+    Iterator& operator+=(difference_type n) { p += n; return *this; }
+    Iterator& operator-=(difference_type n) { p -= n; return *this; }
+    Iterator operator+(difference_type n) const { return Iterator(p + n); }
+    Iterator operator-(difference_type n) const { return Iterator(p - n); }
+    difference_type operator-(const Iterator& other) const { return p - other.p; }
+    friend Iterator operator+(difference_type n, const Iterator& it) { return it + n; }
 };
 
 
+// Вектор с координатами типа T; арифметика constexpr, поэтому
+// выражения над константными векторами вычисляются при компиляции
+template <typename T = int>
 class Vector2d {
 private:
-    int x;
-    int y;
+    T x;
+    T y;
+
+    template <typename>
+    friend class Vector2dBatch;
 
 public:
 
-    Vector2d(int x, int y): x(x), y(y) {
+    constexpr Vector2d(T x, T y) noexcept: x(x), y(y) {
 
     }
 
-    Vector2d(Point2d start, Point2d end): x(end.get_x() - start.get_x()), y(end.get_y() - start.get_y()) {
+    template <T W, T H>
+    constexpr Vector2d(Point2d<T, W, H> start, Point2d<T, W, H> end) noexcept: x(end.get_x() - start.get_x()), y(end.get_y() - start.get_y()) {
 
     }
 
-    int& getitem(int i) {
+    constexpr T& getitem(int i) noexcept {
         if (i == 0){
             return x;
         }
         return y;
     }
 
-    void setitem(int i, int a) {
-        if (i = 0) {
+    constexpr void setitem(int i, T a) noexcept {
+        if (i == 0) {
             x = a;
         } else {
             y = a;
         }
     }
 
-    Iterator begin() {
-        return Iterator(*this);
+    Iterator<T> begin() {
+        return Iterator<T>(*this);
     }
 
-    Iterator end() {
-        return Iterator(*this, len());
+    Iterator<T> end() {
+        return Iterator<T>(*this, len());
     }
 
-    int len() {
+    constexpr T get_x() const noexcept { return x; }
+    constexpr T get_y() const noexcept { return y; }
+
+    constexpr int len() const noexcept {
         return 2;
     }
 
-    bool eq(const Vector2d& other) {
+    constexpr bool eq(const Vector2d& other) const noexcept {
         return x == other.x && y == other.y;
     }
         
-    std::string str() {
-        std::stringstream s;
-        s << "{Vector2d: x = " << x << ", y = " << y << "}"; 
-        return s.str();
+    // Наибольшая длина результата str()/format_to()
+    static constexpr size_t max_str_len = 22 + 2 * max_number_len<T>;
+
+    char* format_to(char* first, char* last) const noexcept {
+        return write_xy(first, last, "Vector2d", x, y);
     }
 
-    double abs() {
-        return std::sqrt(x*x + y*y);
+    std::string str() const {
+        char buf[max_str_len];
+        return std::string(buf, format_to(buf, buf + max_str_len));
     }
 
-    Vector2d operator+(const Vector2d& other) {
+    // Квадраты считаются в double, чтобы большие целые координаты не переполнялись
+    double abs() const noexcept {
+        return std::sqrt((double)x * (double)x + (double)y * (double)y);
+    }
+
+    constexpr Vector2d operator+(const Vector2d& other) const noexcept {
         return Vector2d(x + other.x, y + other.y);
     }
 
-    Vector2d operator-(const Vector2d& other) {
+    constexpr Vector2d operator-(const Vector2d& other) const noexcept {
         return Vector2d(x - other.x, y - other.y);
     }
 
-    Vector2d operator*(int n) {
+    constexpr Vector2d operator*(T n) const noexcept {
         return Vector2d(x * n, y * n);
     }
 
-    Vector2d operator/(int n) {
+    constexpr Vector2d operator/(T n) const noexcept {
         return Vector2d(x / n, y / n);
     }
 
-    int inner_product(const Vector2d& other) {
+    constexpr T inner_product(const Vector2d& other) const noexcept {
         return x * other.x + y * other.y;
     }
 
     // Возвращает 3-ю координату векторного произведения (остальные равны нулю)
-    int cross_product(const Vector2d& other) { 
+    constexpr T cross_product(const Vector2d& other) const noexcept { 
         return x * other.y - y * other.x;
     }
 
-    static int inner_product(const Vector2d& first, const Vector2d& second) {
+    static constexpr T inner_product(const Vector2d& first, const Vector2d& second) noexcept {
         return first.x * second.x + first.y * second.y;
     }
 
     
-    static int cross_product(const Vector2d& first, const Vector2d& second) { 
+    static constexpr T cross_product(const Vector2d& first, const Vector2d& second) noexcept { 
         return first.x * second.y - first.y * second.x;
     }
 
-    int mixed_product(const Vector2d v2, const Vector2d v3) {
+    constexpr T mixed_product(const Vector2d v2, const Vector2d v3) const noexcept {
         return 0; // векторы компланарны
     }
 };
 
+static_assert(std::is_standard_layout_v<Vector2d<int>> && sizeof(Vector2d<int>) == 2 * sizeof(int));
+static_assert(sizeof(Vector2d<double>) == 2 * sizeof(double));
+static_assert(std::contiguous_iterator<Iterator<int>> && std::contiguous_iterator<Iterator<const int>>);
+
+// Все координаты массива векторов одним диапазоном; T может быть const
+template <typename T = int>
+class CoordRange {
+    using Vec = std::conditional_t<std::is_const_v<T>, const Vector2d<std::remove_const_t<T>>, Vector2d<T>>;
+
+    T* first;
+    size_t count;
+
+public:
+    CoordRange(std::span<Vec> vectors): first(reinterpret_cast<T*>(vectors.data())), count(2 * vectors.size()) {}
+
+    Iterator<T> begin() const { return Iterator<T>(first); }
+    Iterator<T> end() const { return Iterator<T>(first + count); }
+    T* data() const { return first; }
+    size_t size() const { return count; }
+    T& operator[](size_t i) const { return first[i]; }
+};
+
+static_assert(Vector2d<int>(1, 2).cross_product(Vector2d<int>(3, 4)) == -2);
+static_assert((Vector2d<double>(1.5, 2) * 2.0).inner_product(Vector2d<double>(1, 1)) == 7.0);
+
+// Невладеющее представление векторов в виде двух столбцов x и y
+// (Vector2dBatch, отображённый в память файл MappedDataset)
+template <typename T = int>
+class Vector2dColumns {
+    const T* xs;
+    const T* ys;
+    size_t count;
+
+public:
+    Vector2dColumns(const T* xs, const T* ys, size_t count): xs(xs), ys(ys), count(count) {}
+
+    Vector2dColumns(std::span<const T> xs, std::span<const T> ys)
+        : xs(xs.data()), ys(ys.data()), count(xs.size() < ys.size() ? xs.size() : ys.size()) {}
+
+    size_t size() const {
+        return count;
+    }
+
+    Vector2d<T> get(size_t i) const {
+        return Vector2d<T>(xs[i], ys[i]);
+    }
+
+    const T* x_data() const { return xs; }
+    const T* y_data() const { return ys; }
+};
+
+// Пакет векторов в виде структуры массивов: x и y хранятся раздельно,
+// поэтому операции над всем пакетом векторизуются (AVX2/SSE, иначе скалярно).
+// Результаты совпадают с соответствующими методами Vector2d.
+// Для int используются ручные SIMD-ядра, для остальных типов - простые
+// циклы, которые компилятор векторизует сам (float удобнее всего).
+template <typename T = int>
+class Vector2dBatch {
+private:
+    std::vector<T> xs;
+    std::vector<T> ys;
+
+public:
+    Vector2dBatch() = default;
+
+    explicit Vector2dBatch(size_t n): xs(n), ys(n) {
+
+    }
+
+    size_t size() const {
+        return xs.size();
+    }
+
+    void resize(size_t n) {
+        xs.resize(n);
+        ys.resize(n);
+    }
+
+    void reserve(size_t n) {
+        xs.reserve(n);
+        ys.reserve(n);
+    }
+
+    void push_back(const Vector2d<T>& v) {
+        xs.push_back(v.x);
+        ys.push_back(v.y);
+    }
+
+    Vector2d<T> get(size_t i) const {
+        return Vector2d<T>(xs[i], ys[i]);
+    }
+
+    void set(size_t i, const Vector2d<T>& v) {
+        xs[i] = v.x;
+        ys[i] = v.y;
+    }
+
+    T* x_data() { return xs.data(); }
+    T* y_data() { return ys.data(); }
+    const T* x_data() const { return xs.data(); }
+    const T* y_data() const { return ys.data(); }
+
+    // Столбцы пакета без копирования
+    operator Vector2dColumns<T>() const {
+        return Vector2dColumns<T>(xs.data(), ys.data(), xs.size());
+    }
+
+    // Операции ниже принимают любые столбцы: пакеты Vector2dBatch или
+    // данные прямо из файла (MappedDataset::columns)
+
+    // out[i] = a[i] + b[i]
+    static void add(Vector2dColumns<T> a, Vector2dColumns<T> b, Vector2dBatch& out) {
+        size_t n = a.size() < b.size() ? a.size() : b.size();
+        out.resize(n);
+        add_kernel(a.x_data(), b.x_data(), out.xs.data(), n);
+        add_kernel(a.y_data(), b.y_data(), out.ys.data(), n);
+    }
+
+    // out[i] = a[i] - b[i]
+    static void subtract(Vector2dColumns<T> a, Vector2dColumns<T> b, Vector2dBatch& out) {
+        size_t n = a.size() < b.size() ? a.size() : b.size();
+        out.resize(n);
+        sub_kernel(a.x_data(), b.x_data(), out.xs.data(), n);
+        sub_kernel(a.y_data(), b.y_data(), out.ys.data(), n);
+    }
+
+    // out[i] = a[i] * k
+    static void scale(Vector2dColumns<T> a, T k, Vector2dBatch& out) {
+        size_t n = a.size();
+        out.resize(n);
+        scale_kernel(a.x_data(), k, out.xs.data(), n);
+        scale_kernel(a.y_data(), k, out.ys.data(), n);
+    }
+
+    // out[i] = a[i].x * b[i].x + a[i].y * b[i].y
+    static void inner_product(Vector2dColumns<T> a, Vector2dColumns<T> b, std::vector<T>& out) {
+        size_t n = a.size() < b.size() ? a.size() : b.size();
+        out.resize(n);
+        dot_kernel(a.x_data(), a.y_data(), b.x_data(), b.y_data(), out.data(), n, false);
+    }
+
+    // out[i] = a[i].x * b[i].y - a[i].y * b[i].x
+    static void cross_product(Vector2dColumns<T> a, Vector2dColumns<T> b, std::vector<T>& out) {
+        size_t n = a.size() < b.size() ? a.size() : b.size();
+        out.resize(n);
+        dot_kernel(a.x_data(), a.y_data(), b.y_data(), b.x_data(), out.data(), n, true);
+    }
+
+    // out[i] = a[i].abs()
+    static void abs(Vector2dColumns<T> a, std::vector<double>& out) {
+        size_t n = a.size();
+        out.resize(n);
+        abs_kernel(a.x_data(), a.y_data(), out.data(), n);
+    }
+
+    // Векторы всех отрезков ломаной за один проход:
+    // out[i] = Vector2d(points[i], points[i + 1]), lengths[i] = out[i].abs().
+    // Начиная с parallel_threshold точек работа делится между потоками.
+    template <T W, T H>
+    static void from_polyline(std::span<const Point2d<T, W, H>> points, Vector2dBatch& out,
+                              std::vector<double>* lengths = nullptr, size_t parallel_threshold = 1 << 18) {
+        size_t n = points.size() < 2 ? 0 : points.size() - 1;
+        out.resize(n);
+        if (lengths) {
+            lengths->resize(n);
+        }
+
+        auto work = [&](size_t from, size_t to) {
+            segments_kernel(points.data() + from, out.xs.data() + from, out.ys.data() + from, to - from);
+            if (lengths) {
+                abs_kernel(out.xs.data() + from, out.ys.data() + from, lengths->data() + from, to - from);
+            }
+        };
+
+        size_t threads = std::thread::hardware_concurrency();
+        if (n < parallel_threshold || threads < 2) {
+            work(0, n);
+            return;
+        }
 
-int& Iterator::operator*() {
-    return vec.getitem(i);
+        std::vector<std::thread> pool;
+        size_t chunk = (n + threads - 1) / threads;
+        for (size_t from = chunk; from < n; from += chunk) {
+            pool.emplace_back(work, from, from + chunk < n ? from + chunk : n);
+        }
+        work(0, chunk);
+        for (auto& t: pool) {
+            t.join();
+        }
+    }
+
+private:
+    // dx[i] = p[i + 1].x - p[i].x, dy[i] = p[i + 1].y - p[i].y
+    template <typename P>
+    static void segments_kernel(const P* p, T* dx, T* dy, size_t n) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        if constexpr (std::is_same_v<T, int> && sizeof(P) == 2 * sizeof(int)) {
+            // Точки лежат парами (x, y): вычитаем сдвинутые на одну точку блоки
+            // и разводим x и y по разным регистрам
+            const int* raw = reinterpret_cast<const int*>(p);
+            for (; i + 8 <= n; i += 8) {
+                __m256i d0 = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(raw + 2 * i + 2)),
+                                              _mm256_loadu_si256((const __m256i*)(raw + 2 * i)));
+                __m256i d1 = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(raw + 2 * i + 10)),
+                                              _mm256_loadu_si256((const __m256i*)(raw + 2 * i + 8)));
+                d0 = _mm256_permute4x64_epi64(_mm256_shuffle_epi32(d0, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+                d1 = _mm256_permute4x64_epi64(_mm256_shuffle_epi32(d1, _MM_SHUFFLE(3, 1, 2, 0)), _MM_SHUFFLE(3, 1, 2, 0));
+                _mm256_storeu_si256((__m256i*)(dx + i), _mm256_permute2x128_si256(d0, d1, 0x20));
+                _mm256_storeu_si256((__m256i*)(dy + i), _mm256_permute2x128_si256(d0, d1, 0x31));
+            }
+        }
+#endif
+        for (; i < n; ++i) {
+            dx[i] = p[i + 1].get_x() - p[i].get_x();
+            dy[i] = p[i + 1].get_y() - p[i].get_y();
+        }
+    }
+
+    template <typename U>
+    static void add_kernel(const U* a, const U* b, U* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = a[i] + b[i];
+        }
+    }
+
+    template <typename U>
+    static void sub_kernel(const U* a, const U* b, U* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = a[i] - b[i];
+        }
+    }
+
+    template <typename U>
+    static void scale_kernel(const U* a, U k, U* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = a[i] * k;
+        }
+    }
+
+    template <typename U>
+    static void dot_kernel(const U* a1, const U* a2, const U* b1, const U* b2, U* out, size_t n, bool negate) {
+        if (negate) {
+            for (size_t i = 0; i < n; ++i) {
+                out[i] = a1[i] * b1[i] - a2[i] * b2[i];
+            }
+        } else {
+            for (size_t i = 0; i < n; ++i) {
+                out[i] = a1[i] * b1[i] + a2[i] * b2[i];
+            }
+        }
+    }
+
+    template <typename U>
+    static void abs_kernel(const U* xs, const U* ys, double* out, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = std::sqrt((double)xs[i] * (double)xs[i] + (double)ys[i] * (double)ys[i]);
+        }
+    }
+
+    // Скалярные варианты считают в unsigned, чтобы переполнение int
+    // давало тот же результат, что и SIMD-инструкции (по модулю 2^32)
+    static int wrap_mul(int a, int b) {
+        return (int)((unsigned)a * (unsigned)b);
+    }
+
+    static void add_kernel(const int* a, const int* b, int* out, size_t n) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 8 <= n; i += 8) {
+            __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+            __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+            _mm256_storeu_si256((__m256i*)(out + i), _mm256_add_epi32(va, vb));
+        }
+#elif defined(__SSE2__)
+        for (; i + 4 <= n; i += 4) {
+            __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+            __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+            _mm_storeu_si128((__m128i*)(out + i), _mm_add_epi32(va, vb));
+        }
+#endif
+        for (; i < n; ++i) {
+            out[i] = (int)((unsigned)a[i] + (unsigned)b[i]);
+        }
+    }
+
+    static void sub_kernel(const int* a, const int* b, int* out, size_t n) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 8 <= n; i += 8) {
+            __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+            __m256i vb = _mm256_loadu_si256((const __m256i*)(b + i));
+            _mm256_storeu_si256((__m256i*)(out + i), _mm256_sub_epi32(va, vb));
+        }
+#elif defined(__SSE2__)
+        for (; i + 4 <= n; i += 4) {
+            __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+            __m128i vb = _mm_loadu_si128((const __m128i*)(b + i));
+            _mm_storeu_si128((__m128i*)(out + i), _mm_sub_epi32(va, vb));
+        }
+#endif
+        for (; i < n; ++i) {
+            out[i] = (int)((unsigned)a[i] - (unsigned)b[i]);
+        }
+    }
+
+    static void scale_kernel(const int* a, int k, int* out, size_t n) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        __m256i vk = _mm256_set1_epi32(k);
+        for (; i + 8 <= n; i += 8) {
+            __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+            _mm256_storeu_si256((__m256i*)(out + i), _mm256_mullo_epi32(va, vk));
+        }
+#elif defined(__SSE4_1__)
+        __m128i vk = _mm_set1_epi32(k);
+        for (; i + 4 <= n; i += 4) {
+            __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+            _mm_storeu_si128((__m128i*)(out + i), _mm_mullo_epi32(va, vk));
+        }
+#endif
+        for (; i < n; ++i) {
+            out[i] = wrap_mul(a[i], k);
+        }
+    }
+
+    // out[i] = a1[i]*b1[i] + a2[i]*b2[i]  (или минус, если negate)
+    static void dot_kernel(const int* a1, const int* a2, const int* b1, const int* b2, int* out, size_t n, bool negate) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 8 <= n; i += 8) {
+            __m256i p1 = _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i*)(a1 + i)), _mm256_loadu_si256((const __m256i*)(b1 + i)));
+            __m256i p2 = _mm256_mullo_epi32(_mm256_loadu_si256((const __m256i*)(a2 + i)), _mm256_loadu_si256((const __m256i*)(b2 + i)));
+            __m256i r = negate ? _mm256_sub_epi32(p1, p2) : _mm256_add_epi32(p1, p2);
+            _mm256_storeu_si256((__m256i*)(out + i), r);
+        }
+#elif defined(__SSE4_1__)
+        for (; i + 4 <= n; i += 4) {
+            __m128i p1 = _mm_mullo_epi32(_mm_loadu_si128((const __m128i*)(a1 + i)), _mm_loadu_si128((const __m128i*)(b1 + i)));
+            __m128i p2 = _mm_mullo_epi32(_mm_loadu_si128((const __m128i*)(a2 + i)), _mm_loadu_si128((const __m128i*)(b2 + i)));
+            __m128i r = negate ? _mm_sub_epi32(p1, p2) : _mm_add_epi32(p1, p2);
+            _mm_storeu_si128((__m128i*)(out + i), r);
+        }
+#endif
+        for (; i < n; ++i) {
+            unsigned p1 = (unsigned)wrap_mul(a1[i], b1[i]);
+            unsigned p2 = (unsigned)wrap_mul(a2[i], b2[i]);
+            out[i] = (int)(negate ? p1 - p2 : p1 + p2);
+        }
+    }
+
+    static void abs_kernel(const int* xs, const int* ys, double* out, size_t n) {
+        size_t i = 0;
+#if defined(__AVX2__)
+        for (; i + 4 <= n; i += 4) {
+            __m256d vx = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)(xs + i)));
+            __m256d vy = _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)(ys + i)));
+            __m256d s = _mm256_add_pd(_mm256_mul_pd(vx, vx), _mm256_mul_pd(vy, vy));
+            _mm256_storeu_pd(out + i, _mm256_sqrt_pd(s));
+        }
+#elif defined(__SSE2__)
+        for (; i + 2 <= n; i += 2) {
+            __m128d vx = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*)(xs + i)));
+            __m128d vy = _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*)(ys + i)));
+            __m128d s = _mm_add_pd(_mm_mul_pd(vx, vx), _mm_mul_pd(vy, vy));
+            _mm_storeu_pd(out + i, _mm_sqrt_pd(s));
+        }
+#endif
+        for (; i < n; ++i) {
+            out[i] = std::sqrt((double)xs[i] * (double)xs[i] + (double)ys[i] * (double)ys[i]);
+        }
+    }
+};
+
+
+
+// Равномерная сетка над областью [0, W] x [0, H] для поиска точек.
+// Точки каждой ячейки лежат подряд в общих массивах (как в CSR), поэтому
+// запросы читают память последовательно. Вставка и удаление только
+// помечают сетку устаревшей, перестройка (сортировка подсчётом) выполняется
+// при первом запросе после изменений.
+template <typename T = int, T W = T(WIDTH), T H = T(HEIGHT)>
+class PointGrid {
+public:
+    using Point = Point2d<T, W, H>;
+
+private:
+    size_t cells_x;
+    size_t cells_y;
+    double inv_cell_w;
+    double inv_cell_h;
+
+    std::vector<Point> points;
+    std::vector<bool> alive;
+    size_t alive_count = 0;
+
+    std::vector<size_t> cell_start;
+    std::vector<Point> cell_points;
+    std::vector<size_t> cell_ids;
+    bool dirty = false;
+
+    size_t cell_x(T x) const {
+        size_t c = (size_t)((double)x * inv_cell_w);
+        return c < cells_x ? c : cells_x - 1;
+    }
+
+    size_t cell_y(T y) const {
+        size_t c = (size_t)((double)y * inv_cell_h);
+        return c < cells_y ? c : cells_y - 1;
+    }
+
+    static double dist2(const Point& a, const Point& b) {
+        double dx = (double)a.get_x() - (double)b.get_x();
+        double dy = (double)a.get_y() - (double)b.get_y();
+        return dx * dx + dy * dy;
+    }
+
+    void rebuild() {
+        size_t cells = cells_x * cells_y;
+        cell_start.assign(cells + 1, 0);
+        std::vector<size_t> cell_of(points.size());
+        for (size_t id = 0; id < points.size(); ++id) {
+            if (alive[id]) {
+                cell_of[id] = cell_y(points[id].get_y()) * cells_x + cell_x(points[id].get_x());
+                ++cell_start[cell_of[id] + 1];
+            }
+        }
+        for (size_t c = 0; c < cells; ++c) {
+            cell_start[c + 1] += cell_start[c];
+        }
+
+        cell_points.resize(alive_count);
+        cell_ids.resize(alive_count);
+        std::vector<size_t> fill(cell_start.begin(), cell_start.end() - 1);
+        for (size_t id = 0; id < points.size(); ++id) {
+            if (alive[id]) {
+                size_t pos = fill[cell_of[id]]++;
+                cell_points[pos] = points[id];
+                cell_ids[pos] = id;
+            }
+        }
+        dirty = false;
+    }
+
+    void ensure_built() {
+        if (dirty) {
+            rebuild();
+        }
+    }
+
+    // Обход ячеек прямоугольника [cx0, cx1] x [cy0, cy1]
+    template <typename F>
+    void for_cells(size_t cx0, size_t cy0, size_t cx1, size_t cy1, F&& f) const {
+        for (size_t cy = cy0; cy <= cy1; ++cy) {
+            for (size_t cx = cx0; cx <= cx1; ++cx) {
+                size_t c = cy * cells_x + cx;
+                for (size_t i = cell_start[c]; i < cell_start[c + 1]; ++i) {
+                    f(i);
+                }
+            }
+        }
+    }
+
+public:
+    PointGrid(size_t cells_x, size_t cells_y): cells_x(cells_x ? cells_x : 1), cells_y(cells_y ? cells_y : 1) {
+        inv_cell_w = W > 0 ? (double)this->cells_x / (double)W : 0.0;
+        inv_cell_h = H > 0 ? (double)this->cells_y / (double)H : 0.0;
+        cell_start.assign(this->cells_x * this->cells_y + 1, 0);
+    }
+
+    // Подбирает сетку так, чтобы в ячейке было около points_per_cell точек
+    static PointGrid for_size(size_t expected_points, size_t points_per_cell = 4) {
+        size_t side = (size_t)std::sqrt((double)expected_points / (double)points_per_cell);
+        return PointGrid(side, side);
+    }
+
+    size_t size() const {
+        return alive_count;
+    }
+
+    // Возвращает идентификатор точки для remove() и результатов запросов
+    size_t insert(const Point& p) {
+        points.push_back(p);
+        alive.push_back(true);
+        ++alive_count;
+        dirty = true;
+        return points.size() - 1;
+    }
+
+    bool remove(size_t id) {
+        if (id >= points.size() || !alive[id]) {
+            return false;
+        }
+        alive[id] = false;
+        --alive_count;
+        dirty = true;
+        return true;
+    }
+
+    const Point& get(size_t id) const {
+        return points[id];
+    }
+
+    // Точки внутри прямоугольника [x0, x1] x [y0, y1] (границы включены)
+    void range(T x0, T y0, T x1, T y1, std::vector<size_t>& out) {
+        ensure_built();
+        out.clear();
+        if (x1 < x0 || y1 < y0 || x1 < 0 || y1 < 0 || x0 > W || y0 > H) {
+            return;
+        }
+        for_cells(cell_x(x0 < 0 ? 0 : x0), cell_y(y0 < 0 ? 0 : y0), cell_x(x1), cell_y(y1), [&](size_t i) {
+            const Point& p = cell_points[i];
+            if (x0 <= p.get_x() && p.get_x() <= x1 && y0 <= p.get_y() && p.get_y() <= y1) {
+                out.push_back(cell_ids[i]);
+            }
+        });
+    }
+
+    // Точки на расстоянии не больше r от center
+    void radius(const Point& center, double r, std::vector<size_t>& out) {
+        ensure_built();
+        out.clear();
+        if (r < 0) {
+            return;
+        }
+        double cx = (double)center.get_x();
+        double cy = (double)center.get_y();
+        size_t cx0 = cell_x(cx - r < 0 ? 0 : (T)(cx - r));
+        size_t cy0 = cell_y(cy - r < 0 ? 0 : (T)(cy - r));
+        size_t cx1 = cell_x(cx + r > (double)W ? W : (T)(cx + r + 1));
+        size_t cy1 = cell_y(cy + r > (double)H ? H : (T)(cy + r + 1));
+        double r2 = r * r;
+        for_cells(cx0, cy0, cx1, cy1, [&](size_t i) {
+            if (dist2(cell_points[i], center) <= r2) {
+                out.push_back(cell_ids[i]);
+            }
+        });
+    }
+
+    // k ближайших к center точек, от ближней к дальней. Ячейки просматриваются
+    // кольцами вокруг ячейки center, пока кольцо может содержать точку ближе k-й
+    std::vector<size_t> nearest(const Point& center, size_t k) {
+        ensure_built();
+        std::vector<std::pair<double, size_t>> best; // max-куча размера k
+        if (k == 0 || alive_count == 0) {
+            return {};
+        }
+        auto consider = [&](size_t i) {
+            double d = dist2(cell_points[i], center);
+            if (best.size() < k) {
+                best.emplace_back(d, cell_ids[i]);
+                std::push_heap(best.begin(), best.end());
+            } else if (d < best.front().first) {
+                std::pop_heap(best.begin(), best.end());
+                best.back() = {d, cell_ids[i]};
+                std::push_heap(best.begin(), best.end());
+            }
+        };
+
+        long long ccx = (long long)cell_x(center.get_x());
+        long long ccy = (long long)cell_y(center.get_y());
+        double cell_w = inv_cell_w > 0 ? 1.0 / inv_cell_w : 0.0;
+        double cell_h = inv_cell_h > 0 ? 1.0 / inv_cell_h : 0.0;
+        long long max_ring = (long long)(cells_x > cells_y ? cells_x : cells_y);
+
+        for (long long ring = 0; ring <= max_ring; ++ring) {
+            if (best.size() == k) {
+                // Любая точка кольца ring дальше, чем (ring - 1) ячеек
+                double gap = (double)(ring - 1) * (cell_w < cell_h ? cell_w : cell_h);
+                if (gap > 0 && gap * gap > best.front().first) {
+                    break;
+                }
+            }
+            for (long long cy = ccy - ring; cy <= ccy + ring; ++cy) {
+                if (cy < 0 || cy >= (long long)cells_y) {
+                    continue;
+                }
+                bool edge_row = cy == ccy - ring || cy == ccy + ring;
+                long long step = edge_row || ring == 0 ? 1 : 2 * ring;
+                for (long long cx = ccx - ring; cx <= ccx + ring; cx += step) {
+                    if (cx < 0 || cx >= (long long)cells_x) {
+                        continue;
+                    }
+                    size_t c = (size_t)cy * cells_x + (size_t)cx;
+                    for (size_t i = cell_start[c]; i < cell_start[c + 1]; ++i) {
+                        consider(i);
+                    }
+                }
+            }
+        }
+
+        std::sort_heap(best.begin(), best.end());
+        std::vector<size_t> ids;
+        ids.reserve(best.size());
+        for (auto& [d, id]: best) {
+            ids.push_back(id);
+        }
+        return ids;
+    }
+};
+
+
+// Порядок свёртки: fast делит массив на столько частей, сколько потоков,
+// deterministic - на блоки фиксированного размера, которые складываются
+// всегда в одном порядке, поэтому результат для float/double не зависит
+// от числа потоков
+enum class ReduceOrder {
+    fast,
+    deterministic
+};
+
+// Параллельные свёртки над массивами Vector2d. Целые накапливаются в
+// long long, вещественные - в double.
+template <typename T = int>
+class Vector2dReducer {
+public:
+    using Acc = wide_t<T>;
+
+private:
+    unsigned threads;
+    ReduceOrder order;
+    size_t block;
+
+    // Складывает chunk(from, to) по частям массива длины n
+    template <typename R, typename Chunk>
+    R reduce(size_t n, R init, Chunk chunk) const {
+        size_t workers = threads;
+        size_t parts = order == ReduceOrder::deterministic ? (n + block - 1) / block : workers;
+        size_t part_size = order == ReduceOrder::deterministic ? block : (n + workers - 1) / workers;
+        if (parts == 0 || part_size == 0) {
+            return init;
+        }
+
+        std::vector<R> partial(parts, init);
+        auto worker = [&](size_t w) {
+            for (size_t p = w; p < parts; p += workers) {
+                size_t from = p * part_size;
+                size_t to = from + part_size < n ? from + part_size : n;
+                if (from < to) {
+                    partial[p] = chunk(from, to);
+                }
+            }
+        };
+
+        if (workers < 2 || n < block) {
+            workers = 1;
+            worker(0);
+        } else {
+            std::vector<std::thread> pool;
+            for (size_t w = 1; w < workers; ++w) {
+                pool.emplace_back(worker, w);
+            }
+            worker(0);
+            for (auto& t: pool) {
+                t.join();
+            }
+        }
+
+        R result = init;
+        for (auto& r: partial) {
+            result = result + r;
+        }
+        return result;
+    }
+
+public:
+    Vector2dReducer(unsigned threads = 0, ReduceOrder order = ReduceOrder::deterministic, size_t block = 1 << 16)
+        : threads(threads ? threads : std::max(1u, std::thread::hardware_concurrency())), order(order), block(block ? block : 1) {}
+
+    // Сумма всех векторов (то же, что цепочка operator+, но без переполнения)
+    Vector2d<Acc> sum(std::span<const Vector2d<T>> v) const {
+        return reduce(v.size(), Vector2d<Acc>(0, 0), [&](size_t from, size_t to) {
+            Acc x = 0, y = 0;
+            for (size_t i = from; i < to; ++i) {
+                x += v[i].get_x();
+                y += v[i].get_y();
+            }
+            return Vector2d<Acc>(x, y);
+        });
+    }
+
+    double sum_abs(std::span<const Vector2d<T>> v) const {
+        return reduce(v.size(), 0.0, [&](size_t from, size_t to) {
+            double s = 0;
+            for (size_t i = from; i < to; ++i) {
+                s += v[i].abs();
+            }
+            return s;
+        });
+    }
+
+    // Сумма a[i].inner_product(b[i])
+    Acc total_inner_product(std::span<const Vector2d<T>> a, std::span<const Vector2d<T>> b) const {
+        size_t n = a.size() < b.size() ? a.size() : b.size();
+        return reduce(n, Acc(0), [&](size_t from, size_t to) {
+            Acc s = 0;
+            for (size_t i = from; i < to; ++i) {
+                s += (Acc)a[i].get_x() * b[i].get_x() + (Acc)a[i].get_y() * b[i].get_y();
+            }
+            return s;
+        });
+    }
+
+    // Удвоенная ориентированная площадь многоугольника с вершинами v[i]
+    // (радиус-векторами): сумма v[i].cross_product(v[i + 1]) по замкнутому контуру
+    Acc signed_area2(std::span<const Vector2d<T>> v) const {
+        size_t n = v.size();
+        if (n < 3) {
+            return 0;
+        }
+        return reduce(n, Acc(0), [&](size_t from, size_t to) {
+            Acc s = 0;
+            for (size_t i = from; i < to; ++i) {
+                const Vector2d<T>& a = v[i];
+                const Vector2d<T>& b = v[i + 1 < n ? i + 1 : 0];
+                s += (Acc)a.get_x() * b.get_y() - (Acc)a.get_y() * b.get_x();
+            }
+            return s;
+        });
+    }
+
+    double signed_area(std::span<const Vector2d<T>> v) const {
+        return (double)signed_area2(v) / 2;
+    }
+
+    // Те же свёртки над столбцами (Vector2dBatch, MappedDataset::columns)
+
+    Vector2d<Acc> sum(Vector2dColumns<T> v) const {
+        const T* xs = v.x_data();
+        const T* ys = v.y_data();
+        return reduce(v.size(), Vector2d<Acc>(0, 0), [&](size_t from, size_t to) {
+            Acc x = 0, y = 0;
+            for (size_t i = from; i < to; ++i) {
+                x += xs[i];
+                y += ys[i];
+            }
+            return Vector2d<Acc>(x, y);
+        });
+    }
+
+    double sum_abs(Vector2dColumns<T> v) const {
+        const T* xs = v.x_data();
+        const T* ys = v.y_data();
+        return reduce(v.size(), 0.0, [&](size_t from, size_t to) {
+            double s = 0;
+            for (size_t i = from; i < to; ++i) {
+                s += std::sqrt((double)xs[i] * xs[i] + (double)ys[i] * ys[i]);
+            }
+            return s;
+        });
+    }
+
+    Acc total_inner_product(Vector2dColumns<T> a, Vector2dColumns<T> b) const {
+        size_t n = a.size() < b.size() ? a.size() : b.size();
+        const T* ax = a.x_data();
+        const T* ay = a.y_data();
+        const T* bx = b.x_data();
+        const T* by = b.y_data();
+        return reduce(n, Acc(0), [&](size_t from, size_t to) {
+            Acc s = 0;
+            for (size_t i = from; i < to; ++i) {
+                s += (Acc)ax[i] * bx[i] + (Acc)ay[i] * by[i];
+            }
+            return s;
+        });
+    }
+
+    // Для столбцов точек (MappedDataset<Point2d>) - площадь многоугольника
+    Acc signed_area2(Vector2dColumns<T> v) const {
+        size_t n = v.size();
+        if (n < 3) {
+            return 0;
+        }
+        const T* xs = v.x_data();
+        const T* ys = v.y_data();
+        return reduce(n, Acc(0), [&](size_t from, size_t to) {
+            Acc s = 0;
+            for (size_t i = from; i < to; ++i) {
+                size_t j = i + 1 < n ? i + 1 : 0;
+                s += (Acc)xs[i] * ys[j] - (Acc)ys[i] * xs[j];
+            }
+            return s;
+        });
+    }
+
+    double signed_area(Vector2dColumns<T> v) const {
+        return (double)signed_area2(v) / 2;
+    }
+};
+
+
+enum class Orientation {
+    clockwise,
+    counterclockwise,
+    degenerate
+};
+
+// Многоугольник как представление над непрерывным буфером вершин.
+// Все проверки - один проход по буферу;
+// произведения координат считаются в wide_t<T> (для целых - long long).
+template <typename T = int, T W = T(WIDTH), T H = T(HEIGHT)>
+class Polygon {
+public:
+    using Point = Point2d<T, W, H>;
+    using Acc = wide_t<T>;
+
+private:
+    std::span<const Point> vertices;
+
+    // Векторное произведение (b - a) x (c - a)
+    static Acc cross(const Point& a, const Point& b, const Point& c) {
+        return ((Acc)b.get_x() - a.get_x()) * ((Acc)c.get_y() - a.get_y())
+             - ((Acc)b.get_y() - a.get_y()) * ((Acc)c.get_x() - a.get_x());
+    }
+
+    // Нижняя полуплоскость направлений: угол от оси x в [pi, 2pi)
+    static bool lower_half(Acc x, Acc y) {
+        return y < 0 || (y == 0 && x < 0);
+    }
+
+    // Угол направления u от оси x меньше угла w (оба в [0, 2pi))
+    static bool angle_less(Acc ux, Acc uy, Acc wx, Acc wy) {
+        bool hu = lower_half(ux, uy), hw = lower_half(wx, wy);
+        return hu != hw ? hw : ux * wy - uy * wx > 0;
+    }
+
+public:
+    Polygon(std::span<const Point> vertices): vertices(vertices) {}
+
+    size_t size() const {
+        return vertices.size();
+    }
+
+    // Удвоенная ориентированная площадь (формула шнурования), > 0 против часовой стрелки
+    Acc signed_area2() const {
+        size_t n = vertices.size();
+        if (n < 3) {
+            return 0;
+        }
+        const Point* v = vertices.data();
+        Acc s = 0;
+        for (size_t i = 0; i + 1 < n; ++i) {
+            s += (Acc)v[i].get_x() * v[i + 1].get_y() - (Acc)v[i].get_y() * v[i + 1].get_x();
+        }
+        s += (Acc)v[n - 1].get_x() * v[0].get_y() - (Acc)v[n - 1].get_y() * v[0].get_x();
+        return s;
+    }
+
+    double signed_area() const {
+        return (double)signed_area2() / 2;
+    }
+
+    double area() const {
+        return std::abs(signed_area());
+    }
+
+    Orientation orientation() const {
+        Acc s = signed_area2();
+        if (s > 0) {
+            return Orientation::counterclockwise;
+        }
+        if (s < 0) {
+            return Orientation::clockwise;
+        }
+        return Orientation::degenerate;
+    }
+
+    // Все повороты в одну сторону и направление рёбер делает ровно один
+    // оборот (иначе спираль или звезда с самопересечениями тоже прошла бы
+    // проверку знаков). Рёбра нулевой длины пропускаются, разворот на 180
+    // градусов делает контур невыпуклым.
+    bool is_convex() const {
+        size_t n = vertices.size();
+        if (n < 3) {
+            return false;
+        }
+        const Point* v = vertices.data();
+        size_t positive = 0, negative = 0, reversals = 0, wraps_ccw = 0, wraps_cw = 0;
+        Acc first_x = 0, first_y = 0, prev_x = 0, prev_y = 0;
+        bool have_prev = false;
+        auto turn = [&](Acc dx, Acc dy) {
+            Acc c = prev_x * dy - prev_y * dx;
+            positive += c > 0;
+            negative += c < 0;
+            reversals += c == 0 && prev_x * dx + prev_y * dy < 0;
+            // Переход направления через ось x при повороте в ту или другую сторону
+            wraps_ccw += c > 0 && angle_less(dx, dy, prev_x, prev_y);
+            wraps_cw += c < 0 && angle_less(prev_x, prev_y, dx, dy);
+        };
+        for (size_t i = 0; i < n; ++i) {
+            const Point& a = v[i];
+            const Point& b = v[i + 1 < n ? i + 1 : 0];
+            Acc dx = (Acc)b.get_x() - a.get_x(), dy = (Acc)b.get_y() - a.get_y();
+            if (dx == 0 && dy == 0) {
+                continue;
+            }
+            if (have_prev) {
+                turn(dx, dy);
+            } else {
+                first_x = dx;
+                first_y = dy;
+                have_prev = true;
+            }
+            prev_x = dx;
+            prev_y = dy;
+        }
+        if (!have_prev) {
+            return false;
+        }
+        turn(first_x, first_y);
+        return reversals == 0 && ((negative == 0 && positive > 0 && wraps_ccw == 1)
+                               || (positive == 0 && negative > 0 && wraps_cw == 1));
+    }
+
+    // Точка внутри или на границе (правило чётности пересечений, точная арифметика)
+    bool contains(const Point& p) const {
+        size_t n = vertices.size();
+        if (n == 0) {
+            return false;
+        }
+        const Point* v = vertices.data();
+        bool inside = false;
+        bool boundary = false;
+        for (size_t i = 0, j = n - 1; i < n; j = i++) {
+            const Point& a = v[j];
+            const Point& b = v[i];
+            Acc c = cross(a, b, p);
+            bool between_y = (a.get_y() > p.get_y()) != (b.get_y() > p.get_y());
+            // Ребро пересекает луч вправо от p, если p лежит слева от ребра, идущего вверх
+            // (или справа от ребра, идущего вниз)
+            inside ^= between_y && ((c > 0) == (b.get_y() > a.get_y())) && c != 0;
+            boundary |= c == 0
+                && std::min(a.get_x(), b.get_x()) <= p.get_x() && p.get_x() <= std::max(a.get_x(), b.get_x())
+                && std::min(a.get_y(), b.get_y()) <= p.get_y() && p.get_y() <= std::max(a.get_y(), b.get_y());
+        }
+        return inside || boundary;
+    }
+};
+
+
+// Точные предикаты для целых координат. Сначала знак считается в double с
+// оценкой погрешности (по Шевчуку); если результат ближе к нулю, чем оценка,
+// то пересчитывается точно в __int128. Счётчики показывают долю быстрых ответов.
+struct PredicateStats {
+    size_t filtered = 0;
+    size_t exact = 0;
+
+    double filtered_rate() const {
+        return filtered + exact ? (double)filtered / (double)(filtered + exact) : 1.0;
+    }
+};
+
+inline thread_local PredicateStats predicate_stats;
+
+// Знак a + b + c для слагаемых, сумма которых может не поместиться в __int128:
+// переполнения учитываются как перенос в 129-й разряд
+inline int exact_sum_sign(__int128 a, __int128 b, __int128 c = 0) {
+    __int128 s;
+    int carry = 0;
+    if (__builtin_add_overflow(a, b, &s)) {
+        carry += a > 0 ? 1 : -1;
+    }
+    __int128 t;
+    if (__builtin_add_overflow(s, c, &t)) {
+        carry += c > 0 ? 1 : -1;
+    }
+    if (carry != 0) {
+        return carry > 0 ? 1 : -1;
+    }
+    return (t > 0) - (t < 0);
+}
+
+// Знак det при |det| > errbound, иначе 0 - нужен точный пересчёт
+inline int filtered_sign(double det, double errbound) {
+    if (det > errbound) {
+        return 1;
+    }
+    if (-det > errbound) {
+        return -1;
+    }
+    return 0;
+}
+
+constexpr double predicate_eps = std::numeric_limits<double>::epsilon();
+
+// Знак векторного произведения a x b: 1 - b левее a, -1 - правее, 0 - коллинеарны.
+// Произведения 64-битных беззнаковых не помещаются в __int128, поэтому они исключены.
+template <typename T> requires (std::is_integral_v<T> && (std::is_signed_v<T> || sizeof(T) < sizeof(long long)))
+int orientation(const Vector2d<T>& a, const Vector2d<T>& b) {
+    double left = (double)a.get_x() * (double)b.get_y();
+    double right = (double)a.get_y() * (double)b.get_x();
+    int sign = filtered_sign(left - right, 8 * predicate_eps * (std::abs(left) + std::abs(right)));
+    if (sign != 0) {
+        ++predicate_stats.filtered;
+        return sign;
+    }
+    ++predicate_stats.exact;
+    return exact_sum_sign((__int128)a.get_x() * b.get_y(), -((__int128)a.get_y() * b.get_x()));
+}
+
+// Для вещественных координат - знак произведения в double, без точного пересчёта
+template <typename T> requires std::is_floating_point_v<T>
+int orientation(const Vector2d<T>& a, const Vector2d<T>& b) {
+    double det = (double)a.get_x() * b.get_y() - (double)a.get_y() * b.get_x();
+    return (det > 0) - (det < 0);
+}
+
+// Знак (b - a) x (c - a): 1 - поворот a, b, c против часовой стрелки,
+// -1 - по часовой, 0 - точки на одной прямой
+template <typename T, T W, T H> requires (!std::is_integral_v<T> || std::is_signed_v<T> || sizeof(T) < sizeof(long long))
+int orientation(const Point2d<T, W, H>& a, const Point2d<T, W, H>& b, const Point2d<T, W, H>& c) {
+    if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        // Координаты неотрицательны, поэтому разности помещаются в T
+        return orientation(Vector2d<T>(a, b), Vector2d<T>(a, c));
+    } else if constexpr (std::is_integral_v<T>) {
+        // Беззнаковые разности переполнились бы, поэтому они берутся в long long
+        return orientation(Vector2d<long long>((long long)b.get_x() - a.get_x(), (long long)b.get_y() - a.get_y()),
+                           Vector2d<long long>((long long)c.get_x() - a.get_x(), (long long)c.get_y() - a.get_y()));
+    } else {
+        // Разности считаются в wide_t<T> (double), чтобы float не терял точность
+        return orientation(Vector2d<wide_t<T>>((wide_t<T>)b.get_x() - a.get_x(), (wide_t<T>)b.get_y() - a.get_y()),
+                           Vector2d<wide_t<T>>((wide_t<T>)c.get_x() - a.get_x(), (wide_t<T>)c.get_y() - a.get_y()));
+    }
+}
+
+// Знак определителя "в круге": 1 - d внутри окружности через a, b, c
+// (a, b, c против часовой стрелки), -1 - снаружи, 0 - на окружности.
+// Точный путь рассчитан на разности координат до 32 бит со знаком, поэтому
+// беззнаковые типы допускаются только до 16 бит.
+template <typename T, T W, T H> requires (std::is_integral_v<T> && sizeof(T) <= 4 && (std::is_signed_v<T> || sizeof(T) < 4))
+int in_circle(const Point2d<T, W, H>& a, const Point2d<T, W, H>& b, const Point2d<T, W, H>& c, const Point2d<T, W, H>& d) {
+    long long adx = (long long)a.get_x() - d.get_x(), ady = (long long)a.get_y() - d.get_y();
+    long long bdx = (long long)b.get_x() - d.get_x(), bdy = (long long)b.get_y() - d.get_y();
+    long long cdx = (long long)c.get_x() - d.get_x(), cdy = (long long)c.get_y() - d.get_y();
+
+    double bdxcdy = (double)bdx * cdy, cdxbdy = (double)cdx * bdy;
+    double cdxady = (double)cdx * ady, adxcdy = (double)adx * cdy;
+    double adxbdy = (double)adx * bdy, bdxady = (double)bdx * ady;
+    double alift = (double)adx * adx + (double)ady * ady;
+    double blift = (double)bdx * bdx + (double)bdy * bdy;
+    double clift = (double)cdx * cdx + (double)cdy * cdy;
+
+    double det = alift * (bdxcdy - cdxbdy) + blift * (cdxady - adxcdy) + clift * (adxbdy - bdxady);
+    double permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * alift
+                     + (std::abs(cdxady) + std::abs(adxcdy)) * blift
+                     + (std::abs(adxbdy) + std::abs(bdxady)) * clift;
+    int sign = filtered_sign(det, 12 * predicate_eps * permanent);
+    if (sign != 0) {
+        ++predicate_stats.filtered;
+        return sign;
+    }
+
+    ++predicate_stats.exact;
+    // Каждое слагаемое по модулю меньше 2^126, сумма - меньше 2^128
+    return exact_sum_sign((__int128)(adx * adx + ady * ady) * (bdx * cdy - cdx * bdy),
+                          (__int128)(bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy),
+                          (__int128)(cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady));
+}
+
+template <typename T, T W, T H>
+bool point_less(const Point2d<T, W, H>& a, const Point2d<T, W, H>& b) {
+    return a.get_x() < b.get_x() || (a.get_x() == b.get_x() && a.get_y() < b.get_y());
+}
+
+// Сортировка по частям в нескольких потоках с последующим попарным слиянием
+template <typename Item, typename Less>
+void parallel_sort(std::vector<Item>& items, Less less, unsigned threads = 0, size_t min_chunk = 1 << 16) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t n = items.size();
+    size_t parts = std::min<size_t>(threads, n / min_chunk);
+    if (parts < 2) {
+        std::sort(items.begin(), items.end(), less);
+        return;
+    }
+
+    std::vector<size_t> bounds;
+    for (size_t p = 0; p <= parts; ++p) {
+        bounds.push_back(n * p / parts);
+    }
+    std::vector<std::thread> pool;
+    for (size_t p = 0; p < parts; ++p) {
+        pool.emplace_back([&, p] { std::sort(items.begin() + bounds[p], items.begin() + bounds[p + 1], less); });
+    }
+    for (auto& t: pool) {
+        t.join();
+    }
+
+    for (size_t width = 1; width < parts; width *= 2) {
+        pool.clear();
+        for (size_t p = 0; p + width < parts; p += 2 * width) {
+            size_t from = bounds[p], mid = bounds[p + width], to = bounds[std::min(p + 2 * width, parts)];
+            pool.emplace_back([&, from, mid, to] {
+                std::inplace_merge(items.begin() + from, items.begin() + mid, items.begin() + to, less);
+            });
+        }
+        for (auto& t: pool) {
+            t.join();
+        }
+    }
+}
+
+// Выпуклая оболочка (монотонная цепочка Эндрю). Вершины против часовой
+// стрелки, начиная с самой левой нижней, без точек на рёбрах.
+template <typename T, T W, T H>
+std::vector<Point2d<T, W, H>> convex_hull(std::vector<Point2d<T, W, H>> points, unsigned threads = 0) {
+    using Point = Point2d<T, W, H>;
+    parallel_sort(points, point_less<T, W, H>, threads);
+    points.erase(std::unique(points.begin(), points.end(), [](const Point& a, const Point& b) { return a.eq(b); }), points.end());
+    if (points.size() < 3) {
+        return points;
+    }
+
+    std::vector<Point> hull(2 * points.size());
+    size_t k = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        while (k >= 2 && orientation(hull[k - 2], hull[k - 1], points[i]) <= 0) {
+            --k;
+        }
+        hull[k++] = points[i];
+    }
+    for (size_t i = points.size() - 1, lower = k + 1; i-- > 0;) {
+        while (k >= lower && orientation(hull[k - 2], hull[k - 1], points[i]) <= 0) {
+            --k;
+        }
+        hull[k++] = points[i];
+    }
+    hull.resize(k - 1);
+    return hull;
+}
+
+
+template <typename T = int, T W = T(WIDTH), T H = T(HEIGHT)>
+struct Segment2d {
+    Point2d<T, W, H> a;
+    Point2d<T, W, H> b;
+
+    Vector2d<T> vector() const {
+        return Vector2d<T>(a, b);
+    }
+};
+
+// Точная проверка пересечения отрезков (включая касание и наложение)
+template <typename T, T W, T H>
+bool segments_intersect(const Segment2d<T, W, H>& s, const Segment2d<T, W, H>& t) {
+    int d1 = orientation(s.a, s.b, t.a);
+    int d2 = orientation(s.a, s.b, t.b);
+    int d3 = orientation(t.a, t.b, s.a);
+    int d4 = orientation(t.a, t.b, s.b);
+    if (d1 * d2 < 0 && d3 * d4 < 0) {
+        return true;
+    }
+    auto on_segment = [](const Point2d<T, W, H>& p, const Point2d<T, W, H>& q, const Point2d<T, W, H>& r) {
+        return std::min(p.get_x(), q.get_x()) <= r.get_x() && r.get_x() <= std::max(p.get_x(), q.get_x())
+            && std::min(p.get_y(), q.get_y()) <= r.get_y() && r.get_y() <= std::max(p.get_y(), q.get_y());
+    };
+    return (d1 == 0 && on_segment(s.a, s.b, t.a)) || (d2 == 0 && on_segment(s.a, s.b, t.b))
+        || (d3 == 0 && on_segment(t.a, t.b, s.a)) || (d4 == 0 && on_segment(t.a, t.b, s.b));
+}
+
+// Все пары пересекающихся отрезков. Заметающая прямая идёт по x: отрезок
+// становится активным на левом конце и выбывает после правого, точная
+// проверка выполняется только для активных отрезков с перекрывающимся
+// диапазоном y. Пары возвращаются как (меньший индекс, больший индекс).
+template <typename T, T W, T H>
+std::vector<std::pair<size_t, size_t>> find_intersections(const std::vector<Segment2d<T, W, H>>& segments, unsigned threads = 0) {
+    struct Span {
+        T x0, x1, y0, y1;
+        size_t id;
+    };
+    std::vector<Span> order;
+    order.reserve(segments.size());
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const auto& s = segments[i];
+        order.push_back({std::min(s.a.get_x(), s.b.get_x()), std::max(s.a.get_x(), s.b.get_x()),
+                         std::min(s.a.get_y(), s.b.get_y()), std::max(s.a.get_y(), s.b.get_y()), i});
+    }
+    parallel_sort(order, [](const Span& l, const Span& r) { return l.x0 < r.x0; }, threads);
+
+    std::vector<std::pair<size_t, size_t>> result;
+    std::vector<Span> active;
+    for (const Span& cur: order) {
+        for (size_t i = 0; i < active.size();) {
+            const Span& other = active[i];
+            if (other.x1 < cur.x0) {
+                active[i] = active.back();
+                active.pop_back();
+                continue;
+            }
+            if (other.y0 <= cur.y1 && cur.y0 <= other.y1 && segments_intersect(segments[other.id], segments[cur.id])) {
+                result.emplace_back(std::min(other.id, cur.id), std::max(other.id, cur.id));
+            }
+            ++i;
+        }
+        active.push_back(cur);
+    }
+    return result;
+}
+
+
+// Двоичный столбцовый формат для массивов Point2d/Vector2d:
+// заголовок 64 байта, затем все x, затем все y (столбцы выровнены на 64 байта).
+// Числа хранятся в порядке байт машины.
+enum class DatasetKind : uint32_t {
+    points = 1,
+    vectors = 2
+};
+
+struct DatasetHeader {
+    char magic[4];
+    uint32_t kind;
+    uint32_t scalar_size;
+    uint32_t scalar_is_float;
+    uint64_t count;
+    uint64_t x_offset;
+    uint64_t y_offset;
+    char reserved[24];
+};
+
+static_assert(sizeof(DatasetHeader) == 64);
+
+template <typename Item>
+struct DatasetTraits;
+
+template <typename T, T W, T H>
+struct DatasetTraits<Point2d<T, W, H>> {
+    using Scalar = T;
+    static constexpr DatasetKind kind = DatasetKind::points;
+};
+
+template <typename T>
+struct DatasetTraits<Vector2d<T>> {
+    using Scalar = T;
+    static constexpr DatasetKind kind = DatasetKind::vectors;
+};
+
+constexpr uint64_t align_column(uint64_t offset) {
+    return (offset + 63) / 64 * 64;
+}
+
+template <typename Item>
+DatasetHeader make_dataset_header(uint64_t count) {
+    using Scalar = typename DatasetTraits<Item>::Scalar;
+    DatasetHeader h{};
+    std::memcpy(h.magic, "G2DC", 4);
+    h.kind = (uint32_t)DatasetTraits<Item>::kind;
+    h.scalar_size = sizeof(Scalar);
+    h.scalar_is_float = std::is_floating_point_v<Scalar>;
+    h.count = count;
+    h.x_offset = sizeof(DatasetHeader);
+    h.y_offset = align_column(h.x_offset + count * sizeof(Scalar));
+    return h;
+}
+
+// Потоковая запись: x сразу пишутся в файл, y копятся во временном файле
+// и дописываются в close(), когда известно число элементов
+template <typename Item>
+class DatasetWriter {
+    using Scalar = typename DatasetTraits<Item>::Scalar;
+
+    FILE* out = nullptr;
+    FILE* ys = nullptr;
+    uint64_t count = 0;
+    bool failed = false;
+
+public:
+    DatasetWriter(const std::string& path) {
+        out = std::fopen(path.c_str(), "wb");
+        ys = std::tmpfile();
+        DatasetHeader placeholder{};
+        failed = !out || !ys || std::fwrite(&placeholder, sizeof(placeholder), 1, out) != 1;
+    }
+
+    DatasetWriter(const DatasetWriter&) = delete;
+    DatasetWriter& operator=(const DatasetWriter&) = delete;
+
+    ~DatasetWriter() {
+        close();
+    }
+
+    bool ok() const {
+        return !failed;
+    }
+
+    void write(const Item& item) {
+        Scalar x = item.get_x();
+        Scalar y = item.get_y();
+        if (!failed) {
+            failed = std::fwrite(&x, sizeof(x), 1, out) != 1 || std::fwrite(&y, sizeof(y), 1, ys) != 1;
+            ++count;
+        }
+    }
+
+    void write(std::span<const Item> items) {
+        for (const Item& item: items) {
+            write(item);
+        }
+    }
+
+    // Дописывает столбец y и заголовок; false, если запись не удалась.
+    // Временный файл закрывается всегда, даже если основной не открылся.
+    bool close() {
+        if (out) {
+            if (!failed) {
+                DatasetHeader h = make_dataset_header<Item>(count);
+                static const char zeros[64] = {};
+                uint64_t pad = h.y_offset - (h.x_offset + count * sizeof(Scalar));
+                failed = std::fwrite(zeros, 1, pad, out) != pad;
+
+                std::rewind(ys);
+                char buf[1 << 16];
+                size_t got;
+                while (!failed && (got = std::fread(buf, 1, sizeof(buf), ys)) > 0) {
+                    failed = std::fwrite(buf, 1, got, out) != got;
+                }
+                failed = failed || std::fseek(out, 0, SEEK_SET) != 0 || std::fwrite(&h, sizeof(h), 1, out) != 1;
+            }
+            failed = std::fclose(out) != 0 || failed;
+            out = nullptr;
+        }
+        if (ys) {
+            std::fclose(ys);
+            ys = nullptr;
+        }
+        return !failed;
+    }
+};
+
+// Файл набора данных, отображённый в память. Столбцы доступны как span без
+// копирования; границы точек при открытии не проверяются (данные считаются
+// проверенными при записи).
+template <typename Item>
+class MappedDataset {
+    using Scalar = typename DatasetTraits<Item>::Scalar;
+
+    void* data = nullptr;
+    size_t length = 0;
+    const DatasetHeader* header = nullptr;
+
+    MappedDataset(void* data, size_t length): data(data), length(length), header((const DatasetHeader*)data) {}
+
+public:
+    static std::optional<MappedDataset> open(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return std::nullopt;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(DatasetHeader)) {
+            ::close(fd);
+            return std::nullopt;
+        }
+        size_t length = (size_t)st.st_size;
+        void* data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            return std::nullopt;
+        }
+
+        MappedDataset dataset(data, length);
+        const DatasetHeader& h = *dataset.header;
+        DatasetHeader expected = make_dataset_header<Item>(h.count);
+        bool valid = std::memcmp(h.magic, expected.magic, 4) == 0 && h.kind == expected.kind
+                  && h.scalar_size == expected.scalar_size && h.scalar_is_float == expected.scalar_is_float
+                  && h.x_offset == expected.x_offset && h.y_offset == expected.y_offset
+                  && h.count <= length / sizeof(Scalar) && h.y_offset + h.count * sizeof(Scalar) <= length;
+        if (!valid) {
+            return std::nullopt;
+        }
+        madvise(data, length, MADV_SEQUENTIAL);
+        return dataset;
+    }
+
+    MappedDataset(MappedDataset&& other) noexcept: data(other.data), length(other.length), header(other.header) {
+        other.data = nullptr;
+        other.header = nullptr;
+    }
+
+    MappedDataset& operator=(MappedDataset&& other) noexcept {
+        std::swap(data, other.data);
+        std::swap(length, other.length);
+        std::swap(header, other.header);
+        return *this;
+    }
+
+    ~MappedDataset() {
+        if (data) {
+            munmap(data, length);
+        }
+    }
+
+    size_t size() const {
+        return header->count;
+    }
+
+    std::span<const Scalar> xs() const {
+        return {(const Scalar*)((const char*)data + header->x_offset), size()};
+    }
+
+    std::span<const Scalar> ys() const {
+        return {(const Scalar*)((const char*)data + header->y_offset), size()};
+    }
+
+    Item get(size_t i) const {
+        return Item(xs()[i], ys()[i]);
+    }
+
+    // Столбцы файла для Vector2dBatch и Vector2dReducer без копирования;
+    // точки в них - радиус-векторы
+    Vector2dColumns<Scalar> columns() const {
+        return Vector2dColumns<Scalar>(xs(), ys());
+    }
+};
+
+
+template <typename F>
+double time_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 }
 
+// Сравнение PointGrid с полным перебором на 1M случайных точек
+void bench_point_grid() {
+    using Point = Point2d<int, 1 << 20, 1 << 20>;
+    const size_t n = 1000000;
+    const int queries = 200;
+
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> coord(0, Point::width);
+    std::vector<Point> points(n);
+    for (auto& p: points) {
+        p = Point(coord(rng), coord(rng));
+    }
+
+    auto grid = PointGrid<int, Point::width, Point::height>::for_size(n);
+    double build = time_ms([&] {
+        for (auto& p: points) {
+            grid.insert(p);
+        }
+        std::vector<size_t> tmp;
+        grid.range(0, 0, 0, 0, tmp);
+    });
+    std::cout << "grid build: " << build << " ms\n";
 
+    std::vector<Point> centers(queries);
+    for (auto& c: centers) {
+        c = Point(coord(rng), coord(rng));
+    }
+    const int half = 4000;
+    const double r = 3000;
+    const size_t k = 8;
 
-int main() {
-    Point2d p1(1,2);
+    size_t grid_found = 0, brute_found = 0;
+    std::vector<size_t> out;
+    double grid_range = time_ms([&] {
+        for (auto& c: centers) {
+            grid.range(c.get_x() - half, c.get_y() - half, c.get_x() + half, c.get_y() + half, out);
+            grid_found += out.size();
+        }
+    });
+    double brute_range = time_ms([&] {
+        for (auto& c: centers) {
+            for (auto& p: points) {
+                brute_found += c.get_x() - half <= p.get_x() && p.get_x() <= c.get_x() + half
+                            && c.get_y() - half <= p.get_y() && p.get_y() <= c.get_y() + half;
+            }
+        }
+    });
+    std::cout << "range:  grid " << grid_range / queries << " ms/query, brute " << brute_range / queries
+              << " ms/query, found " << grid_found << '/' << brute_found << '\n';
+
+    grid_found = brute_found = 0;
+    double grid_radius = time_ms([&] {
+        for (auto& c: centers) {
+            grid.radius(c, r, out);
+            grid_found += out.size();
+        }
+    });
+    double brute_radius = time_ms([&] {
+        for (auto& c: centers) {
+            for (auto& p: points) {
+                double dx = (double)p.get_x() - c.get_x(), dy = (double)p.get_y() - c.get_y();
+                brute_found += dx * dx + dy * dy <= r * r;
+            }
+        }
+    });
+    std::cout << "radius: grid " << grid_radius / queries << " ms/query, brute " << brute_radius / queries
+              << " ms/query, found " << grid_found << '/' << brute_found << '\n';
+
+    size_t mismatches = 0;
+    double grid_knn = 0, brute_knn = 0;
+    for (auto& c: centers) {
+        std::vector<size_t> ids;
+        grid_knn += time_ms([&] { ids = grid.nearest(c, k); });
+        std::vector<std::pair<double, size_t>> all;
+        brute_knn += time_ms([&] {
+            all.clear();
+            for (size_t id = 0; id < n; ++id) {
+                double dx = (double)points[id].get_x() - c.get_x(), dy = (double)points[id].get_y() - c.get_y();
+                all.emplace_back(dx * dx + dy * dy, id);
+            }
+            std::partial_sort(all.begin(), all.begin() + k, all.end());
+        });
+        for (size_t i = 0; i < k; ++i) {
+            mismatches += Vector2d<int>(points[ids[i]], c).abs() != std::sqrt(all[i].first);
+        }
+    }
+    std::cout << "knn:    grid " << grid_knn / queries << " ms/query, brute " << brute_knn / queries
+              << " ms/query, mismatches " << mismatches << '\n';
+}
+
+// Свёртки Vector2dReducer на 1..N потоках
+void bench_reduce() {
+    const size_t n = 10000000;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> coord(-1000, 1000);
+    std::vector<Vector2d<>> v;
+    v.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        v.emplace_back(coord(rng), coord(rng));
+    }
+    std::span<const Vector2d<>> data(v);
+
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> thread_counts;
+    for (unsigned t = 1; t < max_threads; t *= 2) {
+        thread_counts.push_back(t);
+    }
+    thread_counts.push_back(max_threads);
+
+    for (unsigned t: thread_counts) {
+        for (ReduceOrder order: {ReduceOrder::fast, ReduceOrder::deterministic}) {
+            Vector2dReducer<> reducer(t, order);
+            Vector2d<long long> s(0, 0);
+            double abs_sum = 0;
+            long long dot = 0, area2 = 0;
+            double ms_sum = time_ms([&] { s = reducer.sum(data); });
+            double ms_abs = time_ms([&] { abs_sum = reducer.sum_abs(data); });
+            double ms_dot = time_ms([&] { dot = reducer.total_inner_product(data, data); });
+            double ms_area = time_ms([&] { area2 = reducer.signed_area2(data); });
+            std::cout << "threads " << t << (order == ReduceOrder::fast ? " fast         " : " deterministic")
+                      << ": sum " << ms_sum << " ms, abs " << ms_abs << " ms, dot " << ms_dot
+                      << " ms, area " << ms_area << " ms  (" << s.str() << ' ' << abs_sum << ' ' << dot << ' ' << area2 << ")\n";
+        }
+    }
+}
 
-    std::cout << p1.str() << '\n';
+// Оболочка и пересечения на случайных и неудобных входных данных
+void bench_hull() {
+    using Point = Point2d<int, 1 << 30, 1 << 30>;
+    const int side = Point::width;
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> coord(0, side);
+
+    std::vector<Point> cloud(10000000);
+    for (auto& p: cloud) {
+        p = Point(coord(rng), coord(rng));
+    }
+    // Все точки на окружности: каждая входит в оболочку
+    std::vector<Point> circle(1000000);
+    for (size_t i = 0; i < circle.size(); ++i) {
+        double a = 2 * M_PI * i / circle.size();
+        circle[i] = Point((int)(side / 2 + side / 2.5 * std::cos(a)), (int)(side / 2 + side / 2.5 * std::sin(a)));
+    }
+    // Все точки на одной прямой: вырожденная оболочка
+    std::vector<Point> line(1000000);
+    for (size_t i = 0; i < line.size(); ++i) {
+        line[i] = Point((int)i * 1000, (int)i * 1000);
+    }
+
+    for (auto& [name, input]: {std::pair{"random 10M", &cloud}, std::pair{"circle 1M", &circle}, std::pair{"collinear 1M", &line}}) {
+        std::vector<Point> hull;
+        double ms = time_ms([&] { hull = convex_hull(*input); });
+        std::cout << "hull " << name << ": " << ms << " ms, " << hull.size() << " vertices\n";
+    }
+
+    using Segment = Segment2d<int, 1 << 30, 1 << 30>;
+    auto brute = [](const std::vector<Segment>& segments) {
+        size_t count = 0;
+        for (size_t i = 0; i < segments.size(); ++i) {
+            for (size_t j = i + 1; j < segments.size(); ++j) {
+                count += segments_intersect(segments[i], segments[j]);
+            }
+        }
+        return count;
+    };
+
+    std::uniform_int_distribution<int> offset(-side / 200, side / 200);
+    std::vector<Segment> short_segments(20000);
+    for (auto& s: short_segments) {
+        Point a(coord(rng) / 2 + side / 4, coord(rng) / 2 + side / 4);
+        s = {a, Point(a.get_x() + offset(rng), a.get_y() + offset(rng))};
+    }
+    // Решётка длинных горизонтальных и вертикальных отрезков: пересекаются почти все пары
+    std::vector<Segment> lattice;
+    for (int i = 0; i < 1000; ++i) {
+        int c = side / 1000 * i;
+        lattice.push_back({Point(0, c), Point(side, c)});
+        lattice.push_back({Point(c, 0), Point(c, side)});
+    }
+
+    for (auto& [name, input]: {std::pair{"random short 20k", &short_segments}, std::pair{"lattice 2k", &lattice}}) {
+        size_t sweep_found = 0, brute_found = 0;
+        double sweep_ms = time_ms([&] { sweep_found = find_intersections(*input).size(); });
+        double brute_ms = time_ms([&] { brute_found = brute(*input); });
+        std::cout << "intersections " << name << ": sweep " << sweep_ms << " ms, brute " << brute_ms
+                  << " ms, found " << sweep_found << '/' << brute_found << '\n';
+    }
+}
+
+// Доля ответов фильтра для случайных и почти вырожденных входных данных
+void bench_predicates() {
+    using Point = Point2d<int, (1 << 30), (1 << 30)>;
+    const size_t n = 1000000;
+    std::mt19937 rng(13);
+    std::uniform_int_distribution<int> coord(0, Point::width);
+    std::uniform_int_distribution<int> jitter(-1, 1);
+
+    std::vector<Point> random_points(n + 3), near_line(n + 3);
+    for (auto& p: random_points) {
+        p = Point(coord(rng), coord(rng));
+    }
+    // Точки около прямой y = x: большинство троек почти коллинеарны
+    for (auto& p: near_line) {
+        int t = coord(rng) / 2 + 1;
+        p = Point(t, t + jitter(rng));
+    }
+
+    for (auto& [name, points]: {std::pair{"random", &random_points}, std::pair{"near-collinear", &near_line}}) {
+        const auto& v = *points;
+        predicate_stats = {};
+        long long sum = 0;
+        double ms = time_ms([&] {
+            for (size_t i = 0; i < n; ++i) {
+                sum += orientation(v[i], v[i + 1], v[i + 2]);
+            }
+        });
+        std::cout << "orientation " << name << ": " << ms * 1e6 / n << " ns/op, filtered "
+                  << predicate_stats.filtered_rate() * 100 << "% (" << sum << ")\n";
+
+        predicate_stats = {};
+        sum = 0;
+        ms = time_ms([&] {
+            for (size_t i = 0; i < n; ++i) {
+                sum += in_circle(v[i], v[i + 1], v[i + 2], v[i + 3]);
+            }
+        });
+        std::cout << "in_circle " << name << ": " << ms * 1e6 / n << " ns/op, filtered "
+                  << predicate_stats.filtered_rate() * 100 << "% (" << sum << ")\n";
+    }
+}
+
+// Не даёт компилятору выбросить вычисленное значение
+template <typename V>
+inline void keep(const V& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+// Повторяет op(n) (n операций за вызов), пока не наберётся min_ms,
+// и печатает время одной операции и пропускную способность.
+// Первый вызов - прогрев (выделение памяти, кэши), он не учитывается.
+// Время замеряется сериями вызовов примерно по 2^17 операций, чтобы
+// чтение часов не влияло на результат при малых n.
+template <typename Op>
+void bench_op(const char* name, size_t n, Op op, double min_ms = 20) {
+    op(n);
+    size_t batch = std::max<size_t>(1, ((size_t)1 << 17) / n);
+    size_t rounds = 0;
+    double ms = 0;
+    while (ms < min_ms) {
+        ms += time_ms([&] {
+            for (size_t r = 0; r < batch; ++r) {
+                op(n);
+            }
+        });
+        rounds += batch;
+    }
+    double ns_per_op = ms * 1e6 / (double)(rounds * n);
+    std::printf("%-20s %10zu %10.3f ns/op %10.2f Mop/s\n", name, n, ns_per_op, 1e3 / ns_per_op);
+}
+
+// Операции Vector2d и Point2d на массивах от 1 до 10M элементов
+void bench_primitives() {
+    std::mt19937 rng(17);
+    std::uniform_int_distribution<int> coord(1, 1000);
+    std::printf("%-20s %10s %16s %16s\n", "op", "size", "time", "throughput");
+
+    for (size_t n = 1; n <= 10000000; n *= 10) {
+        std::vector<Vector2d<>> a, b;
+        std::vector<Point2d<int, 1000, 1000>> points;
+        a.reserve(n);
+        b.reserve(n);
+        points.reserve(n + 1);
+        for (size_t i = 0; i < n; ++i) {
+            a.emplace_back(coord(rng), coord(rng));
+            b.emplace_back(coord(rng), coord(rng));
+            points.emplace_back(coord(rng), coord(rng));
+        }
+        points.emplace_back(coord(rng), coord(rng));
+        Vector2dBatch<> batch_a, batch_b, batch_out;
+        for (size_t i = 0; i < n; ++i) {
+            batch_a.push_back(a[i]);
+            batch_b.push_back(b[i]);
+        }
+        std::vector<double> lengths;
+
+        bench_op("operator+", n, [&](size_t n) { for (size_t i = 0; i < n; ++i) keep(a[i] + b[i]); });
+        bench_op("operator-", n, [&](size_t n) { for (size_t i = 0; i < n; ++i) keep(a[i] - b[i]); });
+        bench_op("operator*", n, [&](size_t n) { for (size_t i = 0; i < n; ++i) keep(a[i] * 3); });
+        bench_op("operator/", n, [&](size_t n) { for (size_t i = 0; i < n; ++i) keep(a[i] / b[i].get_x()); });
+        bench_op("inner_product", n, [&](size_t n) { for (size_t i = 0; i < n; ++i) keep(a[i].inner_product(b[i])); });
+        bench_op("cross_product", n, [&](size_t n) { for (size_t i = 0; i < n; ++i) keep(a[i].cross_product(b[i])); });
+        bench_op("abs", n, [&](size_t n) { for (size_t i = 0; i < n; ++i) keep(a[i].abs()); });
+        bench_op("eq", n, [&](size_t n) { for (size_t i = 0; i < n; ++i) keep(a[i].eq(b[i])); });
+        bench_op("Iterator", n, [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) {
+                for (auto it = a[i].begin(); it != a[i].end(); ++it) {
+                    keep(*it);
+                }
+            }
+        });
+        bench_op("str", n, [&](size_t n) { for (size_t i = 0; i < n; ++i) keep(a[i].str()); });
+        bench_op("format_to", n, [&](size_t n) {
+            char buf[Vector2d<>::max_str_len];
+            for (size_t i = 0; i < n; ++i) keep(a[i].format_to(buf, buf + sizeof(buf)));
+        });
+        bench_op("Point2d()", n, [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) keep(Point2d<int, 1000, 1000>(a[i].get_x(), a[i].get_y()));
+        });
+        bench_op("Point2d::make", n, [&](size_t n) {
+            for (size_t i = 0; i < n; ++i) keep(Point2d<int, 1000, 1000>::make(a[i].get_x(), a[i].get_y()));
+        });
+        bench_op("Vector2d(p, q)", n, [&](size_t n) { for (size_t i = 0; i < n; ++i) keep(Vector2d<>(points[i], points[i + 1])); });
+        bench_op("batch add", n, [&](size_t) { Vector2dBatch<>::add(batch_a, batch_b, batch_out); keep(batch_out); });
+        bench_op("batch abs", n, [&](size_t) { Vector2dBatch<>::abs(batch_a, lengths); keep(lengths); });
+        std::printf("\n");
+    }
+}
+
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        std::string which = argc > 2 ? argv[2] : "";
+        if (which.empty() || which == "grid") {
+            bench_point_grid();
+        }
+        if (which.empty() || which == "reduce") {
+            bench_reduce();
+        }
+        if (which.empty() || which == "hull") {
+            bench_hull();
+        }
+        if (which.empty() || which == "predicates") {
+            bench_predicates();
+        }
+        if (which.empty() || which == "primitives") {
+            bench_primitives();
+        }
+        return 0;
+    }
+
+    auto p1 = Point2d<>::make(1, 2);
+    if (p1) {
+        std::cout << p1->str() << '\n';
+    }
+    if (!Point2d<>::make(1, 20)) {
+        std::cout << "Point2d: y must be lower or eq " << HEIGHT << " and greater or eq 0\n";
+    }
 
     Vector2d v1(30, 60);
     Vector2d v2(3, 6);
@@ -192,7 +2098,69 @@ int main() {
 
     std::cout << v1.inner_product(v2*4)  << '\n';
     std::cout << v1.cross_product(v2)  << '\n';
-    std::cout << Vector2d::cross_product(v1, v2)  << '\n';
+    std::cout << Vector2d<>::cross_product(v1, v2)  << '\n';
+
+    Vector2dBatch<> a, b, sum;
+    for (int i = 0; i < 10; ++i) {
+        a.push_back(Vector2d<>(i, 2 * i));
+        b.push_back(Vector2d<>(3 - i, i * i));
+    }
+    Vector2dBatch<>::add(a, b, sum);
+    std::vector<int> cross;
+    Vector2dBatch<>::cross_product(a, b, cross);
+    std::cout << sum.get(9).str() << ' ' << cross[9] << '\n';
+
+    std::vector<Point2d<>> polyline = {{0, 0}, {3, 4}, {3, 10}, {10, 10}};
+    Vector2dBatch<> segments;
+    std::vector<double> lengths;
+    Vector2dBatch<>::from_polyline(std::span<const Point2d<>>(polyline), segments, &lengths);
+    for (size_t i = 0; i < segments.size(); ++i) {
+        std::cout << segments.get(i).str() << ' ' << lengths[i] << '\n';
+    }
+
+    PointGrid<> grid(5, 5);
+    for (auto& p: polyline) {
+        grid.insert(p);
+    }
+    std::vector<char> text(polyline.size() * (Point2d<>::max_str_len + 1));
+    char* text_end = format_all(std::span<const Point2d<>>(polyline), text.data(), text.data() + text.size(), ' ');
+    std::cout << std::string_view(text.data(), text_end - text.data()) << '\n';
+
+    for (size_t id: grid.nearest(Point2d<>(4, 5), 2)) {
+        std::cout << grid.get(id).str() << '\n';
+    }
+
+    std::vector<Vector2d<>> square = {{0, 0}, {4, 0}, {4, 4}, {0, 4}};
+    Vector2dReducer<> reducer;
+    std::cout << reducer.sum(square).str() << ' ' << reducer.signed_area(square) << '\n';
+
+    CoordRange<int> coords(square);
+    std::transform(coords.begin(), coords.end(), coords.begin(), [](int c) { return c * 2; });
+    std::cout << square[2].str() << ' ' << std::reduce(coords.begin(), coords.end()) << '\n';
+
+    std::vector<Point2d<>> outline = {{0, 0}, {10, 0}, {10, 10}, {5, 4}, {0, 10}};
+    Polygon<> polygon(outline);
+    std::cout << polygon.area() << ' ' << (polygon.orientation() == Orientation::counterclockwise)
+              << ' ' << polygon.is_convex() << ' ' << polygon.contains(Point2d<>(5, 2))
+              << ' ' << polygon.contains(Point2d<>(5, 8)) << '\n';
+
+    {
+        DatasetWriter<Point2d<>> writer("outline.g2d");
+        writer.write(std::span<const Point2d<>>(outline));
+    }
+    if (auto mapped = MappedDataset<Point2d<>>::open("outline.g2d")) {
+        std::cout << mapped->size() << ' ' << mapped->get(3).str() << ' ' << reducer.signed_area(mapped->columns()) << '\n';
+    }
+    std::remove("outline.g2d");
+
+    for (auto& p: convex_hull(outline)) {
+        std::cout << p.str() << ' ';
+    }
+    std::cout << '\n';
+    std::vector<Segment2d<>> cuts = {{{0, 0}, {10, 10}}, {{0, 10}, {10, 0}}, {{0, 1}, {3, 1}}};
+    for (auto& [i, j]: find_intersections(cuts)) {
+        std::cout << i << " x " << j << '\n';
+    }
 
 
 }
@@ -0,0 +1,28 @@
+#!/bin/sh
+# Встраивает шрифты ascii_5*5.txt и ascii_7*7.txt в fonts.hpp.
+# Запуск после любого изменения файлов шрифтов: ./embed_fonts.sh
+# (./lab2 golden проверяет, что fonts.hpp совпадает с файлами)
+set -e
+cd "$(dirname "$0")"
+
+embed() {
+    if grep -q ')font"' "$2"; then
+        echo "$2: contains )font\"" >&2
+        exit 1
+    fi
+    printf 'constexpr std::string_view %s = R"font(' "$1"
+    cat "$2"
+    printf ')font";\n'
+}
+
+{
+    echo '// Сгенерировано embed_fonts.sh из ascii_5*5.txt и ascii_7*7.txt, вручную'
+    echo '// не редактировать. Printer рисует встроенными шрифтами без чтения файлов.'
+    echo '#pragma once'
+    echo
+    echo '#include <string_view>'
+    echo
+    embed embedded_font5 'ascii_5*5.txt'
+    echo
+    embed embedded_font7 'ascii_7*7.txt'
+} > fonts.hpp
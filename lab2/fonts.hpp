@@ -0,0 +1,21 @@
+// Сгенерировано embed_fonts.sh из ascii_5*5.txt и ascii_7*7.txt, вручную
+// не редактировать. Printer рисует встроенными шрифтами без чтения файлов.
+#pragma once
+
+#include <string_view>
+
+constexpr std::string_view embedded_font5 = R"font(  #  ####  ### #### ########## ### #   # ###  ### #   ##    #   ##   # ### ####  ### ####  ##########   ##   ## # ##   ##   ######     
+ # # #   ##   ##   ##    #    #    #   #  #     # #  # #    ## ####  ##   ##   ##   ##   ##      #  #   ##   ## # # # #  # #    #      
+#   ##### #    #   ##### ###  #  #######  #     # ###  #    # # ## # ##   ##### #   #####  ###   #  #   ##   ## # #  #    #    #       
+######   ##   ##   ##    #    #   ##   #  #     # #  # #   ##   ##  ###   ##    #  ###  #     #  #  #   # # # # # # # #   #   #        
+#   #####  ### #### ######     ### #   # ###  ##  #   #######   ##   # ### #     #####   #####   #   ###   #   # # #   #  #  #####     )font";
+
+constexpr std::string_view embedded_font7 = R"font(  ###  ######   #### #####  ##############  #### ##   ##  ####    #######  ######   ##   ####   ## ##### ######  ##### ######  ##### ###### ##   ####   ####   ####  ## ##  ## #######       
+ ## ##  ##  ## ##  ## ## ##  ##   # ##   # ##  ####   ##   ##      ##  ##  ## ##    ### ######  ####   ## ##  ####   ## ##  ####   ### ## # ##   ####   ####   ####  ## ##  ## #   ##        
+##   ## ##  ####      ##  ## ## #   ## #  ##     ##   ##   ##      ##  ## ##  ##    ########### ####   ## ##  ####   ## ##  ###        ##   ##   ## ## ## ##   ## ####  ##  ##    ##         
+##   ## ##### ##      ##  ## ####   ####  ##     #######   ##      ##  ####   ##    ######### ######   ## ##### ##   ## #####  #####   ##   ##   ## ## ## ## # ##  ##    ####    ##          
+####### ##  ####      ##  ## ## #   ## #  ##  #####   ##   ##  ##  ##  ## ##  ##   ### # ####  #####   ## ##    ##   ## ## ##      ##  ##   ##   ##  ###  ####### ####    ##    ##           
+##   ## ##  ## ##  ## ## ##  ##   # ##     ##  ####   ##   ##  ##  ##  ##  ## ##  ####   ####   ####   ## ##    ##  ### ##  ####   ##  ##   ##   ##  ###  ### #####  ##   ##   ##    #       
+##   ########   #### #####  ###########     #######   ##  ####  ####  ###  ###########   ####   ## ##### ####    ##### #### ## #####  ####   #####    #   ##   ####  ##  ####  #######       
+                                                                                                                        
+)font";
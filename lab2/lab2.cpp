@@ -1,123 +1,905 @@
 #include <string>
 #include <iostream>
-#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <array>
+#include <span>
+#include <string_view>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
 
-int char_to_index(const char c) {
-    if (c == ' ') return 26;
-    return c - 'a';
+#include "fonts.hpp"
+
+
+
+// Разбирает UTF-8 в кодовые точки; некорректные байты заменяются на '?'
+void decode_utf8(const std::string& text, std::vector<char32_t>& out) {
+    out.clear();
+    for (size_t i = 0; i < text.size();) {
+        unsigned char c = text[i];
+        int extra = c < 0x80 ? 0 : (c >> 5) == 0x6 ? 1 : (c >> 4) == 0xE ? 2 : (c >> 3) == 0x1E ? 3 : -1;
+        if (extra < 0 || i + extra >= text.size()) {
+            out.push_back('?');
+            ++i;
+            continue;
+        }
+        char32_t cp = extra == 0 ? c : c & (0x3F >> extra);
+        bool valid = true;
+        for (int k = 1; k <= extra; ++k) {
+            unsigned char next = text[i + k];
+            valid = valid && (next & 0xC0) == 0x80;
+            cp = cp << 6 | (next & 0x3F);
+        }
+        out.push_back(valid ? cp : U'?');
+        i += valid ? extra + 1 : 1;
+    }
 }
 
+// Разбор текста шрифта в атлас: строка n текста - строки n всех глифов
+// подряд по width столбцов. Работает и при компиляции (см. pack_font).
+constexpr void parse_font(std::string_view text, int width, int height, int glyph_count, uint64_t* rows) {
+    int row = 0, column = 0;
+    for (size_t i = 0; i < text.size() && row < height; ++i) {
+        if (text[i] == '\n') {
+            ++row;
+            column = 0;
+            continue;
+        }
+        int glyph = column / width;
+        if (glyph < glyph_count && text[i] == '#') {
+            rows[glyph * height + row] |= (uint64_t)1 << (column % width);
+        }
+        ++column;
+    }
+}
+
+// Атлас шрифта, вычисленный при компиляции (с пустым глифом в конце)
+template <int Width, int Height, int Glyphs>
+constexpr std::array<uint64_t, (Glyphs + 1) * Height> pack_font(std::string_view text) {
+    std::array<uint64_t, (Glyphs + 1) * Height> rows{};
+    parse_font(text, Width, Height, Glyphs, rows.data());
+    return rows;
+}
+
+constexpr auto packed_font5 = pack_font<5, 5, 27>(embedded_font5);
+constexpr auto packed_font7 = pack_font<7, 7, 27>(embedded_font7);
+
+// Верхняя строка буквы 'a': "  #  " и "  ###  "
+static_assert(packed_font5[0] == 0b00100 && packed_font7[0] == 0b0011100);
+
+// spread_bits[f - 1][b]: каждый бит байта b повторён f раз подряд
+constexpr auto spread_bits = [] {
+    std::array<std::array<uint64_t, 256>, 8> table{};
+    for (int f = 1; f <= 8; ++f) {
+        for (int b = 0; b < 256; ++b) {
+            uint64_t v = 0;
+            for (int k = 0; k < 8; ++k) {
+                v |= (uint64_t)((b >> k) & 1) * (((uint64_t)1 << f) - 1) << (k * f);
+            }
+            table[f - 1][b] = v;
+        }
+    }
+    return table;
+}();
+
+// Строка шириной width, растянутая в factor раз (width * factor <= 64, factor <= 8)
+constexpr uint64_t scale_row(uint64_t bits, int width, int factor) {
+    uint64_t result = 0;
+    for (int i = 0; i * 8 < width; ++i) {
+        result |= spread_bits[factor - 1][(bits >> (8 * i)) & 0xFF] << (8 * i * factor);
+    }
+    return result;
+}
+
+static_assert(scale_row(0b101, 3, 2) == 0b110011);
+
+// Шрифт хранится одним непрерывным атласом: строка глифа - одно машинное
+// слово, бит j которого соответствует столбцу j ('#' - 1, ' ' - 0).
+// Строки глифа c лежат подряд: atlas[c * height + n]. Последний глиф атласа
+// пустой - им рисуются символы, которых нет в шрифте. Атлас либо свой
+// (шрифт из файла), либо встроенный в программу (см. fonts.hpp).
 class CharTable {
-    char*** alphabet;
-    int size;
+    std::vector<uint64_t> rows;
+    const uint64_t* atlas;
+    int width;
+    int height;
+    int glyph_count;
+    bool loaded = false;
+    // Номер таблицы, уникальный на всё время работы программы: по нему
+    // кэш Printer отличает глифы разных загрузок одного номера шрифта
+    static inline std::atomic<uint64_t> next_serial{0};
+    uint64_t serial = next_serial++;
+
+    // Глиф для символа: ASCII - прямой таблицей, остальное - через хэш-таблицу
+    int ascii[128];
+    std::unordered_map<char32_t, int> unicode;
+
+    void init_charset(const std::string& charset) {
+        std::vector<char32_t> chars;
+        decode_utf8(charset, chars);
+        glyph_count = (int)chars.size();
+
+        int blank = glyph_count;
+        std::fill(std::begin(ascii), std::end(ascii), -1);
+        for (int i = 0; i < glyph_count; ++i) {
+            if (chars[i] < 128) {
+                ascii[chars[i]] = i;
+            } else {
+                unicode.emplace(chars[i], i);
+            }
+        }
+        // Буквы другого регистра рисуются имеющимися глифами
+        for (int c = 'a'; c <= 'z'; ++c) {
+            int upper = c - 'a' + 'A';
+            if (ascii[c] < 0) ascii[c] = ascii[upper];
+            if (ascii[upper] < 0) ascii[upper] = ascii[c];
+        }
+        for (int& index: ascii) {
+            if (index < 0) index = blank;
+        }
+    }
+
 public:
+    static constexpr const char* default_charset = "abcdefghijklmnopqrstuvwxyz ";
 
-    CharTable(const std::string filename, int size): size(size) {
-        alphabet = new char**[27];
+    // Строка глифа - одно слово uint64_t, поэтому ширина от 1 до 64
+    static constexpr bool valid_size(int width, int height) {
+        return 1 <= width && width <= 64 && height >= 1;
+    }
+
+    // Файл: height строк текста, в каждой подряд строки всех глифов по width
+    // столбцов, в порядке символов charset (UTF-8). Ширина - не больше 64;
+    // при недопустимых размерах файл не читается и таблица не загружена.
+    CharTable(const std::string filename, int width, int height, const std::string& charset = default_charset)
+        : width(width), height(height) {
+        init_charset(charset);
+        if (!valid_size(width, height)) {
+            this->width = this->height = 0;
+            atlas = nullptr;
+            return;
+        }
+        rows.assign((glyph_count + 1) * height, 0);
+        atlas = rows.data();
 
-        for (int i = 0; i < 27; ++i) {
-            alphabet[i] = new char*[size];
-            for (int j = 0; j < size; ++j) {
-                alphabet[i][j] = new char[size];
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return;
+        }
+        size_t length = (size_t)st.st_size;
+        void* data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (data == MAP_FAILED) {
+            return;
+        }
+
+        // Файл разбирается за один проход прямо в атлас
+        parse_font(std::string_view((const char*)data, length), width, height, glyph_count, rows.data());
+        munmap(data, length);
+        loaded = true;
+    }
+
+    // Встроенный атлас (например, packed_font5): без копирования и чтения файлов
+    CharTable(std::span<const uint64_t> packed, int width, int height, const std::string& charset = default_charset)
+        : atlas(packed.data()), width(width), height(height) {
+        init_charset(charset);
+        if (!valid_size(width, height)) {
+            this->width = this->height = 0;
+            atlas = nullptr;
+            return;
+        }
+        loaded = packed.size() >= (size_t)(glyph_count + 1) * height;
+        if (!loaded) {
+            rows.assign((glyph_count + 1) * height, 0);
+            atlas = rows.data();
+        }
+    }
+
+    // Шрифт base, увеличенный в factor раз по обеим осям
+    CharTable(const CharTable& base, int factor)
+        : width(base.width * factor), height(base.height * factor), glyph_count(base.glyph_count),
+          loaded(base.loaded), unicode(base.unicode) {
+        std::copy(std::begin(base.ascii), std::end(base.ascii), ascii);
+        rows.assign((glyph_count + 1) * height, 0);
+        for (int g = 0; g < glyph_count; ++g) {
+            for (int r = 0; r < base.height; ++r) {
+                uint64_t scaled = scale_row(base.get_row(g, r), base.width, factor);
+                std::fill_n(rows.begin() + g * height + r * factor, factor, scaled);
             }
         }
-        
-        std::ifstream fin;
-        fin.open(filename);
+        atlas = rows.data();
+    }
+
+    CharTable(const CharTable&) = delete;
+    CharTable& operator=(const CharTable&) = delete;
 
+    CharTable(const std::string filename, int size): CharTable(filename, size, size) {}
+
+    bool is_loaded() const {
+        return loaded;
+    }
 
-        char trash;
+    uint64_t get_serial() const {
+        return serial;
+    }
+
+    int get_row_count() const {
         
-        for (int i = 0; i < size; ++i) {
-            for (int j = 0; j < 27; ++j) {
-                
-                fin.read(alphabet[j][i], size);
-                
+        return height;
+    }
+
+    int get_width() const {
+        return width;
+    }
+
+    // Номер глифа для кодовой точки (пустой глиф, если символа нет)
+    int glyph_index(char32_t c) const {
+        if (c < 128) {
+            return ascii[c];
+        }
+        auto it = unicode.find(c);
+        return it != unicode.end() ? it->second : glyph_count;
+    }
+
+    // Строка n глифа c в виде битовой маски
+    uint64_t get_row(int c, int n) const {
+        return atlas[c * height + n];
+    }
+};
+
+
+// Реестр шрифтов: номер шрифта (тот же, что char_size у Printer) ->
+// файл и его параметры. Файл загружается при первом обращении.
+// При повторной регистрации номера старая таблица (и таблицы шрифтов,
+// увеличенных из неё) не удаляется, а откладывается: указатели на неё
+// могут ещё быть у Printer. Следующее обращение загрузит шрифт заново.
+// Регистрация и загрузка идут под одной блокировкой, поэтому реестром
+// можно пользоваться из нескольких потоков.
+class FontRegistry {
+    struct Font {
+        std::string filename;
+        std::span<const uint64_t> packed;
+        int width;
+        int height;
+        std::string charset;
+        std::unique_ptr<CharTable> table;
+        bool scaled = false;
+        int base_id = 0;
+        int factor = 1;
+    };
+
+    std::unordered_map<int, Font> fonts;
+    std::vector<std::unique_ptr<CharTable>> retired;
+    std::atomic<uint64_t> generation{0};
+    std::mutex mutex;
+
+    // Откладывает таблицы шрифта id и всех шрифтов, увеличенных из него
+    void retire(int id) {
+        auto it = fonts.find(id);
+        if (it == fonts.end()) {
+            return;
+        }
+        if (it->second.table) {
+            retired.push_back(std::move(it->second.table));
+            ++generation;
+        }
+        for (auto& [other, font]: fonts) {
+            if (font.scaled && font.base_id == id) {
+                retire(other);
             }
-            fin.read(&trash, 1);
         }
-        fin.close();
-        
     }
-    int get_row_count() {
-        
-        return size;
+
+    void replace(int id, Font font) {
+        retire(id);
+        fonts[id] = std::move(font);
     }
 
-    std::string get_row(char c, int n) {
-        std::string str;
-        str.resize(size);
-        
-        memcpy(str.data() , alphabet[c][n], size);
-        
-        return str;
+    // Загружает шрифт при первом обращении; вызывается под mutex
+    CharTable* load(int id) {
+        auto it = fonts.find(id);
+        if (it == fonts.end()) {
+            return nullptr;
+        }
+        Font& font = it->second;
+        if (!font.table && font.scaled) {
+            CharTable* base = load(font.base_id);
+            if (!base) {
+                return nullptr;
+            }
+            font.table = std::make_unique<CharTable>(*base, font.factor);
+        } else if (!font.table && !font.packed.empty()) {
+            font.table = std::make_unique<CharTable>(font.packed, font.width, font.height, font.charset);
+        } else if (!font.table) {
+            font.table = std::make_unique<CharTable>(font.filename, font.width, font.height, font.charset);
+        }
+        // Файл не найден или не прочитан: повторно не читается до новой регистрации
+        return font.table->is_loaded() ? font.table.get() : nullptr;
+    }
+
+    // Стандартные шрифты встроены в программу и не читаются с диска
+    FontRegistry() {
+        register_font(5, packed_font5, 5, 5);
+        register_font(7, packed_font7, 7, 7);
+    }
+
+public:
+    static FontRegistry& instance() {
+        static FontRegistry registry;
+        return registry;
+    }
+
+    // false при недопустимых размерах (ширина от 1 до 64, высота от 1)
+    bool register_font(int id, const std::string& filename, int width, int height,
+                       const std::string& charset = CharTable::default_charset) {
+        if (!CharTable::valid_size(width, height)) {
+            return false;
+        }
+        std::lock_guard lock(mutex);
+        replace(id, Font{filename, {}, width, height, charset, nullptr});
+        return true;
+    }
+
+    bool register_font(int id, std::span<const uint64_t> packed, int width, int height,
+                       const std::string& charset = CharTable::default_charset) {
+        if (!CharTable::valid_size(width, height)) {
+            return false;
+        }
+        std::lock_guard lock(mutex);
+        replace(id, Font{"", packed, width, height, charset, nullptr});
+        return true;
+    }
+
+    // Шрифт base_id, увеличенный в factor раз (от 1 до 8, ширина до 64).
+    // base_id не может сам быть увеличен из id (цепочка без циклов).
+    bool register_scaled(int id, int base_id, int factor) {
+        std::lock_guard lock(mutex);
+        auto base = fonts.find(base_id);
+        if (base == fonts.end() || factor < 1 || factor > 8 || base->second.width * factor > 64) {
+            return false;
+        }
+        for (auto it = base; it != fonts.end(); it = it->second.scaled ? fonts.find(it->second.base_id) : fonts.end()) {
+            if (it->first == id) {
+                return false;
+            }
+        }
+        Font font{"", {}, base->second.width * factor, base->second.height * factor, base->second.charset, nullptr};
+        font.scaled = true;
+        font.base_id = base_id;
+        font.factor = factor;
+        replace(id, std::move(font));
+        return true;
+    }
+
+    // Меняется при каждой замене загруженной таблицы
+    uint64_t get_generation() const {
+        return generation;
+    }
+
+    // nullptr, если шрифт не зарегистрирован или не загрузился
+    CharTable* get(int id) {
+        std::lock_guard lock(mutex);
+        return load(id);
     }
 };
 
 
+// Развёртка битовой маски строки глифа в байты: бит 1 -> symbol, 0 -> ' '.
+// Векторный вариант пишет сразу expand_block байт, поэтому может записать
+// лишнее за width - вызывающий код должен оставить под это место.
+#if defined(__AVX2__)
+constexpr int expand_block = 32;
+#elif defined(__SSE2__)
+constexpr int expand_block = 16;
+#else
+constexpr int expand_block = 1;
+#endif
+
+inline void expand_bits(uint64_t bits, int width, char symbol, char* out) {
+#if defined(__AVX2__)
+    // Байт k маски размножается на байты 8k..8k+7, затем каждый байт
+    // сравнивается со своим битом
+    const __m256i spread = _mm256_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1,
+                                            2, 2, 2, 2, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3);
+    const __m256i select = _mm256_set1_epi64x((long long)0x8040201008040201ULL);
+    const __m256i fill = _mm256_set1_epi8(symbol);
+    const __m256i space = _mm256_set1_epi8(' ');
+    for (int k = 0; k < width; k += 32) {
+        __m256i v = _mm256_shuffle_epi8(_mm256_set1_epi32((int)(uint32_t)(bits >> k)), spread);
+        __m256i set = _mm256_cmpeq_epi8(_mm256_and_si256(v, select), select);
+        _mm256_storeu_si256((__m256i*)(out + k), _mm256_blendv_epi8(space, fill, set));
+    }
+#elif defined(__SSE2__)
+    const __m128i select = _mm_set1_epi64x((long long)0x8040201008040201ULL);
+    const __m128i fill = _mm_set1_epi8(symbol);
+    const __m128i space = _mm_set1_epi8(' ');
+    for (int k = 0; k < width; k += 16) {
+        uint64_t lo = (bits >> k) & 0xFF, hi = (bits >> (k + 8)) & 0xFF;
+        __m128i v = _mm_set_epi64x((long long)(hi * 0x0101010101010101ULL), (long long)(lo * 0x0101010101010101ULL));
+        __m128i set = _mm_cmpeq_epi8(_mm_and_si128(v, select), select);
+        _mm_storeu_si128((__m128i*)(out + k), _mm_or_si128(_mm_and_si128(set, fill), _mm_andnot_si128(set, space)));
+    }
+#else
+    for (int k = 0; k < width; ++k) {
+        out[k] = (bits >> k) & 1 ? symbol : ' ';
+    }
+#endif
+}
+
+// Строки count глифов подряд, после каждого глифа - пробел;
+// в out должно быть count * (width + 1) байт
+void expand_rows(const uint64_t* bits, size_t count, int width, char symbol, char* out) {
+    char* end = out + count * (width + 1);
+    size_t span = (width + expand_block - 1) / expand_block * expand_block;
+    for (size_t g = 0; g < count; ++g) {
+        if (out + span <= end) {
+            expand_bits(bits[g], width, symbol, out);
+        } else {
+            char tmp[64 + expand_block];
+            expand_bits(bits[g], width, symbol, tmp);
+            std::memcpy(out, tmp, width);
+        }
+        out[width] = ' ';
+        out += width + 1;
+    }
+}
+
+
 
 enum class Color {
     Red = 31, Green = 32, Blue = 34
 };
 
+// Вывод глифов символами блоков Unicode: half - две строки глифа в одной
+// строке терминала, quadrant - квадрат 2x2 пикселя в одном символе
+enum class BlockStyle {
+    half, quadrant
+};
+
+// Индекс - биты заполненных частей: для half 1 - верх, 2 - низ; для quadrant
+// 1 - левый верхний, 2 - правый верхний, 4 - левый нижний, 8 - правый нижний
+constexpr std::string_view half_blocks[4] = {" ", "\u2580", "\u2584", "\u2588"};
+constexpr std::string_view quadrant_blocks[16] = {
+    " ", "\u2598", "\u259D", "\u2580", "\u2596", "\u258C", "\u259E", "\u259B",
+    "\u2597", "\u259A", "\u2590", "\u259C", "\u2584", "\u2599", "\u259F", "\u2588"
+};
+
+// Кадр терминала из ячеек (символ + цвет). Хранит предыдущий выведенный
+// кадр и при выводе передаёт в терминал только изменившиеся ячейки,
+// перемещая курсор escape-последовательностями.
+class FrameBuffer {
+    struct Cell {
+        char ch = ' ';
+        uint8_t color = 0; // 0 - цвет терминала по умолчанию
+
+        bool operator==(const Cell& other) const = default;
+    };
+
+    int width;
+    int height;
+    std::vector<Cell> current;
+    std::vector<Cell> previous;
+    bool first_frame = true;
+    std::string buffer;
+
+public:
+    FrameBuffer(int width, int height): width(width), height(height), current(width * height), previous(width * height) {}
+
+    int get_width() const {
+        return width;
+    }
+
+    int get_height() const {
+        return height;
+    }
+
+    void clear() {
+        std::fill(current.begin(), current.end(), Cell{});
+    }
+
+    // Ячейки за пределами кадра отбрасываются
+    void put(int x, int y, char ch, Color color) {
+        if (0 <= x && x < width && 0 <= y && y < height) {
+            current[y * width + x] = Cell{ch, (uint8_t)color};
+        }
+    }
+
+    // Дописывает в out команды, превращающие прошлый кадр в текущий,
+    // и запоминает текущий кадр как выведенный
+    void render_diff(std::string& out) {
+        if (first_frame) {
+            out += "\u001b[2J";
+            std::fill(previous.begin(), previous.end(), Cell{});
+            first_frame = false;
+        }
+
+        int cursor_x = -1, cursor_y = -1;
+        uint8_t color = 0;
+        char code[32];
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const Cell& cell = current[y * width + x];
+                if (cell == previous[y * width + x]) {
+                    continue;
+                }
+                if (x != cursor_x || y != cursor_y) {
+                    out.append(code, std::snprintf(code, sizeof(code), "\u001b[%d;%dH", y + 1, x + 1));
+                }
+                if (cell.color != color) {
+                    out.append(code, std::snprintf(code, sizeof(code), "\u001b[%dm", cell.color));
+                    color = cell.color;
+                }
+                out.push_back(cell.ch);
+                cursor_x = x + 1;
+                cursor_y = y;
+            }
+        }
+        if (color != 0) {
+            out += "\u001b[0m";
+        }
+        previous = current;
+    }
+
+    // Дописывает весь кадр построчно, без перемещений курсора;
+    // код цвета выводится только там, где цвет меняется
+    void render_full(std::string& out) const {
+        uint8_t color = 0;
+        char code[16];
+        for (int y = 0; y < height; ++y) {
+            for (int x = 0; x < width; ++x) {
+                const Cell& cell = current[y * width + x];
+                if (cell.color != color) {
+                    out.append(code, std::snprintf(code, sizeof(code), "\u001b[%dm", cell.color));
+                    color = cell.color;
+                }
+                out.push_back(cell.ch);
+            }
+            out.push_back('\n');
+        }
+        if (color != 0) {
+            out += "\u001b[0m";
+        }
+    }
+
+    // Выводит изменения одной записью; возвращает число записанных байт
+    size_t present() {
+        buffer.clear();
+        render_diff(buffer);
+        std::cout.write(buffer.data(), buffer.size());
+        std::cout.flush();
+        return buffer.size();
+    }
+};
+
+
+// Надпись для пакетного вывода; position - столбец и строка на общем холсте
+struct PrintJob {
+    std::string text;
+    Color color;
+    std::pair<int, int> position;
+    char symbol;
+    int size;
+};
+
 class Printer {
     std::string text;
     Color color;
     std::pair<int, int> position;
     char symbol;
     int size;
-public:
-    static CharTable char_table5;
-    static CharTable char_table7;
+    std::string buffer;
+    std::vector<char32_t> codepoints;
+    std::vector<const char*> glyphs;
+    unsigned threads = 1;
+    size_t parallel_threshold = 1 << 14;
 
+    // Кэш развёрнутых глифов: ключ - (шрифт, символ заливки, глиф),
+    // значение - все строки глифа, уже с символом заливки и пробелом после
+    // каждой строки (width + 1 байт на строку).
+    // Кэш и счётчики свои у каждого потока: Printer в разных потоках не
+    // делят изменяемых данных и не ждут блокировок, а Printer одного потока
+    // пользуются общим кэшем. Потоки set_parallel только читают уже
+    // развёрнутые глифы потока, вызвавшего render_to.
+    // Шрифт в ключе - номер таблицы (CharTable::get_serial), а не номер
+    // шрифта: после повторной регистрации шрифта старые глифы не находятся.
+    // Когда реестр заменяет таблицы, кэш потока очищается целиком.
+    using GlyphCache = std::unordered_map<uint64_t, std::string>;
+    static thread_local std::unordered_map<uint64_t, GlyphCache> glyph_cache;
+    static thread_local uint64_t cache_generation;
+    static thread_local size_t cache_hits;
+    static thread_local size_t cache_misses;
+
+    // Вызывается в начале рендера, пока нет указателей на глифы из кэша
+    static void sync_cache() {
+        uint64_t generation = FontRegistry::instance().get_generation();
+        if (generation != cache_generation) {
+            glyph_cache.clear();
+            cache_generation = generation;
+        }
+    }
+
+    const char* expanded_glyph(const CharTable& char_table, GlyphCache& cache, int index) const {
+        int rows = char_table.get_row_count();
+        int width = char_table.get_width();
+        uint64_t key = (uint64_t)(unsigned char)symbol << 32 | (uint32_t)index;
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            ++cache_hits;
+            return it->second.data();
+        }
+
+        ++cache_misses;
+        std::string expanded(rows * (width + 1), ' ');
+        for (int i = 0; i < rows; ++i) {
+            uint64_t bits = char_table.get_row(index, i);
+            expand_rows(&bits, 1, width, symbol, expanded.data() + i * (width + 1));
+        }
+        return cache.emplace(key, std::move(expanded)).first->second.data();
+    }
+
+    // Уже развёрнутые glyphs в кадр, левый верхний угол - position
+    void draw_glyphs(FrameBuffer& frame, const CharTable& char_table) const {
+        int rows = char_table.get_row_count();
+        int width = char_table.get_width();
+        for (int i = 0; i < rows; ++i) {
+            int x = position.first;
+            for (const char* glyph: glyphs) {
+                for (int k = 0; k <= width; ++k) {
+                    frame.put(x++, position.second + i, glyph[i * (width + 1) + k], color);
+                }
+            }
+        }
+    }
+
+    // Глифы [from, to) текста во всех строках; строка i начинается с base + i * row_len,
+    // глифы - после left пробелов отступа
+    void write_glyphs(char* base, size_t row_len, size_t left, int rows, int width, size_t from, size_t to) const {
+        for (int i = 0; i < rows; ++i) {
+            char* p = base + i * row_len + left + from * (width + 1);
+            for (size_t g = from; g < to; ++g) {
+                std::memcpy(p, glyphs[g] + i * (width + 1), width + 1);
+                p += width + 1;
+            }
+        }
+    }
+
+public:
 
 
 
     Printer(Color color, std::pair<int, int> position, char symbol, int char_size): color(color), position(position), symbol(symbol), size(char_size) {}
 
-    void print(std::string text) {
-        CharTable* char_table;
+    // Тексты от threshold символов рендерятся в threads потоков (0 - по числу
+    // ядер): каждый поток пишет свой диапазон символов во все строки баннера
+    void set_parallel(unsigned threads, size_t threshold = 1 << 14) {
+        this->threads = threads ? threads : std::max(1u, std::thread::hardware_concurrency());
+        parallel_threshold = threshold;
+    }
+
+    // Дописывает в out весь баннер: отступ сверху, код цвета, строки глифов
+    // с отступом слева и сброс цвета. Возвращает false, если нет шрифта.
+    bool render_to(std::string& out, const std::string& text) {
+        sync_cache();
+        CharTable* char_table = FontRegistry::instance().get(size);
+        if (!char_table) {
+            return false;
+        }
+
+        // Отрицательные отступы считаются нулевыми
+        size_t left = std::max(0, position.first);
+        size_t top = std::max(0, position.second);
+        std::string color_code = "\u001b[" + std::to_string((int)color) + "m";
+        decode_utf8(text, codepoints);
+        int rows = char_table->get_row_count();
+        int width = char_table->get_width();
+        size_t row_len = left + codepoints.size() * (width + 1) + 1;
+        size_t start = out.size();
+        out.resize(start + top + color_code.size() + rows * row_len + 4);
+
+        char* p = out.data() + start;
+        p = std::fill_n(p, top, '\n');
+        p = std::copy(color_code.begin(), color_code.end(), p);
+        
+        // Развёрнутые строки каждого символа текста берутся из кэша
+        glyphs.clear();
+        GlyphCache& cache = glyph_cache[char_table->get_serial()];
+        for (char32_t c: codepoints) {
+            glyphs.push_back(expanded_glyph(*char_table, cache, char_table->glyph_index(c)));
+        }
+        
+        // Отступы и переводы строк на своих местах, глифы пишутся по диапазонам
+        for (int i = 0; i < rows; ++i) {
+            std::fill_n(p + i * row_len, left, ' ');
+            p[i * row_len + row_len - 1] = '\n';
+        }
 
-        if (size == 5) {
-            char_table = &Printer::char_table5;
-        } else if (size == 7) {
-            char_table = &Printer::char_table7;
+        size_t count = glyphs.size();
+        if (threads < 2 || count < parallel_threshold) {
+            write_glyphs(p, row_len, left, rows, width, 0, count);
         } else {
-            std::cerr << "cant find font with size: " << size << std::endl;
-            return ;
+            std::vector<std::thread> pool;
+            size_t chunk = (count + threads - 1) / threads;
+            for (size_t from = chunk; from < count; from += chunk) {
+                pool.emplace_back([=, this] { write_glyphs(p, row_len, left, rows, width, from, std::min(from + chunk, count)); });
+            }
+            write_glyphs(p, row_len, left, rows, width, 0, chunk);
+            for (auto& t: pool) {
+                t.join();
+            }
         }
+        p += rows * row_len;
+        std::memcpy(p, "\u001b[0m", 4);
+        return true;
+    }
 
-        for (int i = 0; i < position.second; ++i) {
-            std::cout << '\n';
+    // Как render_to, но пиксели рисуются блоками Unicode (symbol не используется):
+    // строк вдвое меньше, для quadrant ещё и вдвое меньше столбцов
+    bool render_blocks_to(std::string& out, const std::string& text, BlockStyle style) {
+        CharTable* char_table = FontRegistry::instance().get(size);
+        if (!char_table) {
+            return false;
         }
 
-        std::string tmp;
-        std::cout << "\u001b[" << (int)color << "m";
-        
-        for (int i = 0; i < char_table->get_row_count(); ++i) {
-            
-            for (int j = 0; j < position.first; ++j) {
-                std::cout << ' ';
-            }
-            
-            for (char c: text) {
-                tmp = char_table->get_row(char_to_index(c), i);
-                for (char ch: tmp) {
-                    if (ch == '#') {
-                        std::cout << symbol;
-                    } else if(ch == ' ') {
-                        std::cout << ' ';
+        // Отрицательные отступы считаются нулевыми, как в render_to
+        size_t left = std::max(0, position.first);
+        size_t top = std::max(0, position.second);
+        decode_utf8(text, codepoints);
+        int rows = char_table->get_row_count();
+        int width = char_table->get_width();
+        out.append(top, '\n');
+        out += "\u001b[" + std::to_string((int)color) + "m";
+
+        for (int i = 0; i < rows; i += 2) {
+            out.append(left, ' ');
+            for (char32_t c: codepoints) {
+                int index = char_table->glyph_index(c);
+                uint64_t top = char_table->get_row(index, i);
+                uint64_t bottom = i + 1 < rows ? char_table->get_row(index, i + 1) : 0;
+                if (style == BlockStyle::half) {
+                    for (int k = 0; k < width; ++k) {
+                        out += half_blocks[((top >> k) & 1) | ((bottom >> k) & 1) << 1];
+                    }
+                } else {
+                    for (int k = 0; k < width; k += 2) {
+                        out += quadrant_blocks[((top >> k) & 3) | ((bottom >> k) & 3) << 2];
                     }
                 }
-                std::cout << ' ';
+                out.push_back(' ');
+            }
+            out.push_back('\n');
+        }
+        out += "\u001b[0m";
+        return true;
+    }
+
+    // Рисует баннер в кадр: position - столбец и строка левого верхнего угла
+    bool draw(FrameBuffer& frame, const std::string& text) {
+        sync_cache();
+        CharTable* char_table = FontRegistry::instance().get(size);
+        if (!char_table) {
+            return false;
+        }
+
+        decode_utf8(text, codepoints);
+        glyphs.clear();
+        GlyphCache& cache = glyph_cache[char_table->get_serial()];
+        for (char32_t c: codepoints) {
+            glyphs.push_back(expanded_glyph(*char_table, cache, char_table->glyph_index(c)));
+        }
+        draw_glyphs(frame, *char_table);
+        return true;
+    }
+
+    // Рисует все надписи на общем холсте и дописывает его в out одним куском.
+    // Шрифт ищется один раз на группу надписей с одинаковым шрифтом, глифы
+    // берутся из общего кэша; накладываются надписи в порядке jobs.
+    // Надписи с незарегистрированным шрифтом пропускаются, возвращается их число.
+    static size_t render_batch_to(std::string& out, const std::vector<PrintJob>& jobs) {
+        std::vector<size_t> order(jobs.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return std::pair(jobs[a].size, jobs[a].symbol) < std::pair(jobs[b].size, jobs[b].symbol);
+        });
+
+        struct Resolved {
+            const CharTable* table = nullptr;
+            std::vector<const char*> glyphs;
+        };
+        std::vector<Resolved> resolved(jobs.size());
+        sync_cache();
+        Printer printer(Color::Red, {0, 0}, ' ', 0);
+        CharTable* table = nullptr;
+        GlyphCache* cache = nullptr;
+        int width = 0, height = 0;
+        size_t skipped = 0;
+
+        for (size_t n = 0; n < order.size(); ++n) {
+            const PrintJob& job = jobs[order[n]];
+            if (n == 0 || job.size != jobs[order[n - 1]].size) {
+                table = FontRegistry::instance().get(job.size);
+                cache = table ? &glyph_cache[table->get_serial()] : nullptr;
+            }
+            if (!table) {
+                ++skipped;
+                continue;
+            }
+            printer.size = job.size;
+            printer.symbol = job.symbol;
+            decode_utf8(job.text, printer.codepoints);
+            Resolved& r = resolved[order[n]];
+            r.table = table;
+            for (char32_t c: printer.codepoints) {
+                r.glyphs.push_back(printer.expanded_glyph(*table, *cache, table->glyph_index(c)));
             }
+            width = std::max(width, job.position.first + (int)r.glyphs.size() * (table->get_width() + 1));
+            height = std::max(height, job.position.second + table->get_row_count());
+        }
+
+        FrameBuffer canvas(width, height);
+        for (size_t j = 0; j < jobs.size(); ++j) {
+            if (resolved[j].table) {
+                printer.color = jobs[j].color;
+                printer.position = jobs[j].position;
+                printer.glyphs = std::move(resolved[j].glyphs);
+                printer.draw_glyphs(canvas, *resolved[j].table);
+            }
+        }
+        canvas.render_full(out);
+        return skipped;
+    }
+
+    static void print_batch(const std::vector<PrintJob>& jobs) {
+        std::string out;
+        render_batch_to(out, jobs);
+        std::cout.write(out.data(), out.size());
+    }
 
-            std::cout << '\n';
+    // Баннер собирается целиком в буфере и выводится одной записью
+    void print(std::string text) {
+        buffer.clear();
+        if (!render_to(buffer, text)) {
+            std::cerr << "cant find font with size: " << size << std::endl;
+            return ;
         }
-        std::cout << "\u001b[0m";
+        std::cout.write(buffer.data(), buffer.size());
+    }
+
+    // Счётчики и очистка относятся к кэшу текущего потока
+    static size_t get_cache_hits() {
+        return cache_hits;
+    }
+
+    static size_t get_cache_misses() {
+        return cache_misses;
+    }
+
+    static void clear_cache() {
+        glyph_cache.clear();
+        cache_hits = 0;
+        cache_misses = 0;
     }
 
     static void print(std::string text, Color color, std::pair<int, int> position, char symbol, int char_size) {
@@ -130,12 +912,348 @@ public:
 
 };
 
-CharTable Printer::char_table5("ascii_5*5.txt", 5);
+thread_local std::unordered_map<uint64_t, Printer::GlyphCache> Printer::glyph_cache;
+thread_local uint64_t Printer::cache_generation = 0;
+thread_local size_t Printer::cache_hits = 0;
+thread_local size_t Printer::cache_misses = 0;
+
+template <typename F>
+double time_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
 
-CharTable Printer::char_table7("ascii_7*7.txt", 7);
+// Развёртка строк 7x7 для текста из 10k символов: побитовый цикл против expand_rows
+void bench_expand() {
+    CharTable* font = FontRegistry::instance().get(7);
+    const int width = font->get_width();
+    const int rows = font->get_row_count();
+    const int repeats = 200;
 
-int main() {
+    std::string text;
+    for (int i = 0; i < 10000; ++i) {
+        text.push_back("abcdefghijklmnopqrstuvwxyz "[i * 7 % 27]);
+    }
+    std::vector<std::vector<uint64_t>> row_bits(rows);
+    for (int i = 0; i < rows; ++i) {
+        for (char c: text) {
+            row_bits[i].push_back(font->get_row(font->glyph_index(c), i));
+        }
+    }
+    std::string scalar(text.size() * (width + 1), ' '), simd(scalar);
 
+    double scalar_ms = time_ms([&] {
+        for (int r = 0; r < repeats; ++r) {
+            for (int i = 0; i < rows; ++i) {
+                char* p = scalar.data();
+                for (uint64_t bits: row_bits[i]) {
+                    for (int k = 0; k < width; ++k) {
+                        *p++ = (bits >> k) & 1 ? '@' : ' ';
+                    }
+                    *p++ = ' ';
+                }
+            }
+        }
+    });
+    double simd_ms = time_ms([&] {
+        for (int r = 0; r < repeats; ++r) {
+            for (int i = 0; i < rows; ++i) {
+                expand_rows(row_bits[i].data(), row_bits[i].size(), width, '@', simd.data());
+            }
+        }
+    });
+
+    double glyph_rows = (double)repeats * rows * text.size();
+    std::cout << "expand scalar: " << scalar_ms * 1e6 / glyph_rows << " ns/glyph row\n";
+    std::cout << "expand simd:   " << simd_ms * 1e6 / glyph_rows << " ns/glyph row (block " << expand_block
+              << ", " << (scalar == simd ? "identical" : "DIFFERENT") << ")\n";
+}
+
+// Объём вывода при перерисовке меняющегося баннера: весь кадр против разницы
+void bench_diff() {
+    FrameBuffer frame(80, 10);
+    Printer title(Color::Green, {1, 1}, '#', 5);
+    Printer counter(Color::Red, {1, 7}, '*', 5);
+    size_t full_bytes = 0, diff_bytes = 0;
+    std::string out;
+    for (int tick = 0; tick < 100; ++tick) {
+        std::string value = "tick " + std::string(1, 'a' + tick % 26);
+        Printer full_title(Color::Green, {1, 1}, '#', 5);
+        out.clear();
+        full_title.render_to(out, "status");
+        Printer full_counter(Color::Red, {1, 0}, '*', 5);
+        full_counter.render_to(out, value);
+        full_bytes += out.size();
+
+        frame.clear();
+        title.draw(frame, "status");
+        counter.draw(frame, value);
+        out.clear();
+        frame.render_diff(out);
+        diff_bytes += out.size();
+    }
+    std::cout << "100 redraws: full " << full_bytes << " bytes, diff " << diff_bytes << " bytes\n";
+}
+
+// Рендер длинного текста в один и в несколько потоков
+void bench_parallel() {
+    std::string text;
+    for (int i = 0; i < 200000; ++i) {
+        text.push_back("abcdefghijklmnopqrstuvwxyz "[i * 11 % 27]);
+    }
+    Printer serial(Color::Red, {2, 1}, '#', 7);
+    std::string expected;
+    serial.render_to(expected, text);
+
+    unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned t = 1; t <= max_threads; t *= 2) {
+        Printer printer(Color::Red, {2, 1}, '#', 7);
+        printer.set_parallel(t);
+        std::string out;
+        double ms = time_ms([&] {
+            for (int r = 0; r < 20; ++r) {
+                out.clear();
+                printer.render_to(out, text);
+            }
+        });
+        std::cout << "render 200k chars, " << t << " threads: " << ms / 20 << " ms ("
+                  << (out == expected ? "identical" : "DIFFERENT") << ")\n";
+    }
+}
+
+// Тексты для проверки и замеров рендера
+std::vector<std::string> render_corpus() {
+    std::vector<std::string> corpus = {
+        "hello oop",
+        "abcdefghijklmnopqrstuvwxyz",
+        "the quick brown fox jumps over the lazy dog",
+        "Mixed CASE, digits 0123 and symbols !?",
+    };
+    std::string long_text;
+    for (int i = 0; i < 300; ++i) {
+        long_text.push_back("abcdefghijklmnopqrstuvwxyz "[i * 5 % 27]);
+    }
+    corpus.push_back(long_text);
+    return corpus;
+}
+
+// Эталон для шрифта: все тексты корпуса подряд
+std::string render_golden(int font, bool parallel) {
+    std::string out;
+    for (const std::string& text: render_corpus()) {
+        Printer printer(Color::Blue, {2, 1}, '#', font);
+        if (parallel) {
+            printer.set_parallel(4, 1);
+        }
+        printer.render_to(out, text);
+    }
+    return out;
+}
+
+// Номер шрифта 5x5, увеличенного вдвое, для эталонов
+constexpr int golden_scaled_font = 10;
+
+// Короткие тексты корпуса (без длинного) в блоках Unicode всеми шрифтами
+std::string render_golden_blocks() {
+    std::vector<std::string> corpus = render_corpus();
+    corpus.pop_back();
+    std::string out;
+    for (int font: {5, 7, golden_scaled_font}) {
+        for (BlockStyle style: {BlockStyle::half, BlockStyle::quadrant}) {
+            for (const std::string& text: corpus) {
+                Printer printer(Color::Green, {1, 1}, '#', font);
+                printer.render_blocks_to(out, text, style);
+            }
+        }
+    }
+    return out;
+}
+
+// Несколько кадров с меняющимися надписями: вывод render_diff подряд
+std::string render_golden_frames() {
+    FrameBuffer frame(64, 16);
+    Printer title(Color::Green, {1, 1}, '#', 5);
+    Printer counter(Color::Red, {1, 7}, '*', 7);
+    std::string out;
+    for (const char* value: {"tick a", "tick b", "tock b", "", "done"}) {
+        frame.clear();
+        title.draw(frame, "status");
+        counter.draw(frame, value);
+        frame.render_diff(out);
+    }
+    return out;
+}
+
+// Пакет надписей разными шрифтами с наложением и неизвестным шрифтом
+std::string render_golden_batch() {
+    std::string out;
+    size_t skipped = Printer::render_batch_to(out, {
+        {"cpu", Color::Green, {0, 0}, '#', 5},
+        {"ok", Color::Blue, {20, 0}, '*', 7},
+        {"mem", Color::Red, {0, 6}, '#', 5},
+        {"over", Color::Blue, {10, 3}, '+', 5},
+        {"big", Color::Green, {0, 12}, '@', golden_scaled_font},
+        {"none", Color::Red, {0, 0}, '#', 99},
+    });
+    out += "skipped " + std::to_string(skipped) + "\n";
+    return out;
+}
+
+// Сверяет пути рендера с файлами каталога dir: у каждого файла - один
+// или несколько путей, которые должны давать одинаковый результат
+// (например, холодный и тёплый кэш). С update - перезаписывает эталоны
+// первым путём. 0 - всё совпало.
+int check_golden(const std::string& dir, bool update) {
+    FontRegistry::instance().register_scaled(golden_scaled_font, 5, 2);
+    auto cold = [](auto render) {
+        return [render] {
+            Printer::clear_cache();
+            return render();
+        };
+    };
+    struct GoldenCase {
+        std::string file;
+        std::vector<std::pair<const char*, std::function<std::string()>>> paths;
+    };
+    std::vector<GoldenCase> cases;
+    for (int font: {5, 7}) {
+        cases.push_back({"font" + std::to_string(font) + ".txt", {
+            {"cold cache", cold([font] { return render_golden(font, false); })},
+            {"warm cache", [font] { return render_golden(font, false); }},
+            {"parallel", [font] { return render_golden(font, true); }},
+        }});
+    }
+    cases.push_back({"scaled.txt", {
+        {"cold cache", cold([] { return render_golden(golden_scaled_font, false); })},
+        {"warm cache", [] { return render_golden(golden_scaled_font, false); }},
+        {"parallel", [] { return render_golden(golden_scaled_font, true); }},
+    }});
+    cases.push_back({"blocks.txt", {{"render_blocks_to", render_golden_blocks}}});
+    cases.push_back({"frames.txt", {
+        {"cold cache", cold(render_golden_frames)},
+        {"warm cache", render_golden_frames},
+    }});
+    cases.push_back({"batch.txt", {
+        {"cold cache", cold(render_golden_batch)},
+        {"warm cache", render_golden_batch},
+    }});
+
+    int failures = 0;
+    for (const GoldenCase& c: cases) {
+        std::string path = dir + "/" + c.file;
+        if (update) {
+            std::string out = c.paths[0].second();
+            FILE* file = std::fopen(path.c_str(), "wb");
+            bool ok = file && std::fwrite(out.data(), 1, out.size(), file) == out.size();
+            ok = file && std::fclose(file) == 0 && ok;
+            std::cout << (ok ? "updated " : "cannot write ") << path << '\n';
+            failures += !ok;
+            continue;
+        }
+
+        std::string expected;
+        if (FILE* file = std::fopen(path.c_str(), "rb")) {
+            char buf[1 << 14];
+            size_t got;
+            while ((got = std::fread(buf, 1, sizeof(buf), file)) > 0) {
+                expected.append(buf, got);
+            }
+            std::fclose(file);
+        } else {
+            std::cout << "missing " << path << '\n';
+            ++failures;
+            continue;
+        }
+
+        for (auto& [name, render]: c.paths) {
+            std::string out = render();
+            auto diff = std::mismatch(out.begin(), out.end(), expected.begin(), expected.end());
+            bool same = diff.first == out.end() && diff.second == expected.end();
+            std::cout << c.file << ", " << name << ": ";
+            if (same) {
+                std::cout << "ok\n";
+            } else {
+                std::cout << "differs at byte " << diff.first - out.begin() << '\n';
+                ++failures;
+            }
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// Сверяет встроенные шрифты (fonts.hpp) с файлами, из которых их
+// генерирует embed_fonts.sh. 0 - совпадают.
+int check_embedded_fonts(const std::string& dir) {
+    struct Embedded {
+        const char* file;
+        int size;
+        std::span<const uint64_t> packed;
+    };
+    int failures = 0;
+    for (const Embedded& font: {Embedded{"ascii_5*5.txt", 5, packed_font5}, Embedded{"ascii_7*7.txt", 7, packed_font7}}) {
+        std::string path = dir + "/" + font.file;
+        CharTable table(path, font.size);
+        bool same = table.is_loaded();
+        for (size_t i = 0; same && i < font.packed.size(); ++i) {
+            same = table.get_row(i / font.size, i % font.size) == font.packed[i];
+        }
+        std::cout << "fonts.hpp vs " << path << ": " << (same ? "ok" : "differs, run embed_fonts.sh") << '\n';
+        failures += !same;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+// Пропускная способность рендера корпуса в оба шрифта
+void bench_corpus() {
+    std::vector<std::string> corpus = render_corpus();
+    size_t chars = 0;
+    for (auto& text: corpus) {
+        chars += text.size();
+    }
+    const int repeats = 2000;
+    for (int font: {5, 7}) {
+        std::string out;
+        size_t bytes = 0;
+        double ms = time_ms([&] {
+            for (int r = 0; r < repeats; ++r) {
+                for (auto& text: corpus) {
+                    out.clear();
+                    Printer printer(Color::Blue, {2, 1}, '#', font);
+                    printer.render_to(out, text);
+                    bytes += out.size();
+                }
+            }
+        });
+        std::cout << "corpus font " << font << ": " << bytes / (ms * 1e3) << " MB/s, "
+                  << ms * 1e6 / ((double)repeats * chars) << " ns/glyph\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        bench_corpus();
+        bench_expand();
+        bench_parallel();
+        bench_diff();
+        return 0;
+    }
+    // golden [update] [каталог]: по умолчанию эталоны ищутся в golden/
+    // рядом с программой, а не в текущем каталоге; файлы шрифтов - в
+    // каталоге над эталонами
+    if (argc > 1 && std::string(argv[1]) == "golden") {
+        bool update = false;
+        std::string dir = (std::filesystem::path(argv[0]).parent_path() / "golden").string();
+        for (int i = 2; i < argc; ++i) {
+            if (std::string(argv[i]) == "update") {
+                update = true;
+            } else {
+                dir = argv[i];
+            }
+        }
+        int failed = check_golden(dir, update);
+        return check_embedded_fonts((std::filesystem::path(dir) / "..").string()) | failed;
+    }
 
     Printer printer(Color::Blue, std::pair<int, int>(1, 1), '?', 5);
 
@@ -144,5 +1262,11 @@ int main() {
     Printer::print("abc", Color::Red, std::pair<int, int>(10,2), '1', 7);
     Printer::print("red", Color::Green, std::pair<int, int>(0,0), '@', 5);
 
+    Printer::print_batch({
+        {"cpu", Color::Green, {0, 0}, '#', 5},
+        {"ok", Color::Blue, {20, 0}, '*', 7},
+        {"mem", Color::Red, {0, 6}, '#', 5},
+    });
+
 
 }
\ No newline at end of file